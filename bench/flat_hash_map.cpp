@@ -0,0 +1,68 @@
+#include <flat_hash_map.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Returns `n` distinct pseudo-random keys; the odd ones are never inserted.
+ */
+static std::vector<uint64_t> make_keys(size_t n, bool present) {
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> keys(n);
+  for (auto & k : keys) k = (rng() << 1) | (present ? 0 : 1);
+  return keys;
+}
+
+/**
+ * @brief Adapts `std::unordered_map` to the interface of `FlatHashMap`.
+ */
+struct StdMap {
+  std::unordered_map<uint64_t, uint64_t> m;
+  StdMap() : m() {}
+  bool insert(uint64_t k, uint64_t v) { return m.emplace(k, v).second; }
+  const uint64_t * find(uint64_t k) const {
+    auto it = m.find(k);
+    return it == m.end() ? nullptr : &it->second;
+  }
+};
+
+template<typename Map>
+static void BM_Insert(benchmark::State & state) {
+  const auto keys = make_keys(static_cast<size_t>(state.range(0)), true);
+  for (auto _ : state) {
+    Map m;
+    for (uint64_t k : keys) m.insert(k, k);
+    benchmark::DoNotOptimize(m);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Map>
+static void BM_Lookup(benchmark::State & state, bool hit) {
+  const auto keys = make_keys(static_cast<size_t>(state.range(0)), true);
+  const auto queries = make_keys(static_cast<size_t>(state.range(0)), hit);
+  Map m;
+  for (uint64_t k : keys) m.insert(k, k);
+  for (auto _ : state)
+    for (uint64_t q : queries) benchmark::DoNotOptimize(m.find(q));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Map>
+static void BM_LookupHit(benchmark::State & state) { BM_Lookup<Map>(state, true); }
+
+template<typename Map>
+static void BM_LookupMiss(benchmark::State & state) { BM_Lookup<Map>(state, false); }
+
+using Flat = FlatHashMap<uint64_t, uint64_t>;
+
+BENCHMARK(BM_Insert<Flat>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_Insert<StdMap>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_LookupHit<Flat>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_LookupHit<StdMap>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_LookupMiss<Flat>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_LookupMiss<StdMap>)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
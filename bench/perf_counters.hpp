@@ -0,0 +1,163 @@
+#ifndef PERF_COUNTERS_HXX
+#define PERF_COUNTERS_HXX
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Returns the `perf_event_attr` configuration counting the read misses of a cache.
+ */
+constexpr uint64_t perf_read_miss(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+/**
+ * @class PerfCounters
+ * @brief Hardware performance counters of the calling thread, reported as benchmark counters.
+ *
+ * A `PerfCounters` opens one `perf_event_open` counter per hardware event (cycles, instructions,
+ * L1D and LLC misses, branch misses and dTLB misses) and starts them on construction; `report()`
+ * stops them and publishes their values per element as custom counters of a benchmark, together
+ * with the IPC. Events are opened independently, so an event the PMU does not support (as in
+ * many virtual machines) only drops its own counter. When perf events are not permitted at all
+ * (`perf_event_paranoid`, containers) or not available (non-Linux systems), no counter is
+ * reported and the benchmark is labelled accordingly.
+ *
+ * Comparing misses and IPC per element tells whether a kernel is memory-bound (high misses per
+ * element, low IPC) or compute-bound (few misses, IPC close to the width of the core).
+ */
+class PerfCounters {
+private:
+
+  struct Event {
+    const char * name; ///< The name of the counter, as reported.
+    uint32_t type;     ///< The `perf_event_attr` type of the event.
+    uint64_t config;   ///< The `perf_event_attr` configuration of the event.
+  };
+
+#if defined(__linux__)
+  static constexpr Event EVENTS[] = {
+   {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+   {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+   {"L1D-misses", PERF_TYPE_HW_CACHE, perf_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+   {"LLC-misses", PERF_TYPE_HW_CACHE, perf_read_miss(PERF_COUNT_HW_CACHE_LL)},
+   {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+   {"dTLB-misses", PERF_TYPE_HW_CACHE, perf_read_miss(PERF_COUNT_HW_CACHE_DTLB)},
+  };
+#else
+  static constexpr Event EVENTS[] = {{"cycles", 0, 0}};
+#endif
+
+  static constexpr size_t N = sizeof(EVENTS) / sizeof(EVENTS[0]); ///< The number of events.
+
+  int fd_[N]; ///< The file descriptor of each event, or -1 if it could not be opened.
+
+  /*–
+   * AF: the counts of the events EVENTS[i] such that fd_[i] ≥ 0, since construction.
+   *
+   * ---
+   *
+   * RI: - fd_[i] ≥ 0 ⇒ fd_[i] is an open perf event counting EVENTS[i] for this thread
+   */
+
+#if defined(__linux__)
+  /**
+   * @brief Opens a disabled counter of `e` for the calling thread, in user space only.
+   *
+   * @return The file descriptor of the counter, or -1 if the event is not available.
+   */
+  static int open(const Event & e) noexcept {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = e.type;
+    attr.config = e.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  /**
+   * @brief Reads a counter, scaling it up if the kernel multiplexed it with other events.
+   */
+  static bool read_scaled(int fd, double & value) noexcept {
+    uint64_t buf[3];
+    if (::read(fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) return false;
+    value = static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+    return true;
+  }
+#endif
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Opens and starts the counters that are available.
+   */
+  PerfCounters() noexcept : fd_() {
+    for (size_t i = 0; i < N; ++i) {
+#if defined(__linux__)
+      fd_[i] = open(EVENTS[i]);
+#else
+      fd_[i] = -1;
+#endif
+    }
+#if defined(__linux__)
+    for (size_t i = 0; i < N; ++i)
+      if (fd_[i] >= 0) ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0), ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  /**
+   * @brief Stops the counters and reports them per element as custom counters of `state`.
+   *
+   * @param state The benchmark to report to.
+   * @param elems The number of elements processed while counting.
+   */
+  void report(benchmark::State & state, int64_t elems) noexcept {
+    double value[N] = {};
+    bool ok[N] = {};
+    size_t available = 0;
+#if defined(__linux__)
+    for (size_t i = 0; i < N; ++i)
+      if (fd_[i] >= 0) ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+    for (size_t i = 0; i < N; ++i)
+      if (fd_[i] >= 0 && read_scaled(fd_[i], value[i])) ok[i] = true, ++available;
+#endif
+    if (available == 0) return state.SetLabel("perf events unavailable");
+    const double n = elems > 0 ? static_cast<double>(elems) : 1;
+    for (size_t i = 0; i < N; ++i)
+      if (ok[i]) state.counters[std::string(EVENTS[i].name) + "/elem"] = value[i] / n;
+    if (ok[0] && ok[1] && value[0] > 0) state.counters["IPC"] = value[1] / value[0];
+  }
+
+  /**
+   * @brief Destructor.
+   *
+   * Closes the counters.
+   */
+  ~PerfCounters() noexcept {
+#if defined(__linux__)
+    for (size_t i = 0; i < N; ++i)
+      if (fd_[i] >= 0) close(fd_[i]);
+#endif
+  }
+};
+
+#endif // PERF_COUNTERS_HXX
@@ -0,0 +1,94 @@
+#include <search_index.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+/*
+ * Benchmarks of the lookups of `SearchIndex`, one query at a time and in batches, against
+ * `std::lower_bound` over the flat sorted `Slice`, for 10^6 keys (within the LLC) and 10^8 keys
+ * (well past it, where a binary search takes a cache miss per halving step). Each benchmark runs
+ * the same pseudo-random queries, hits and misses alike, and reports the time per lookup and the
+ * hardware counters per lookup (see perf_counters.hpp), when perf events are available.
+ */
+
+/**
+ * @brief The sorted keys of a benchmark and the index over them, built once per size.
+ */
+struct Keys {
+  Slice<uint32_t> keys;       ///< The keys 0, 3, 6, …, sorted.
+  SearchIndex<uint32_t> index; ///< The index over `keys`.
+  Slice<uint32_t> queries;    ///< Pseudo-random queries over the range of `keys`.
+};
+
+static constexpr size_t QUERIES = size_t(1) << 16; ///< The lookups per iteration.
+
+/**
+ * @brief Returns the keys of a benchmark of `n` keys, building them on first use.
+ */
+static const Keys & keys(size_t n) {
+  static std::map<size_t, std::unique_ptr<Keys>> cache;
+  auto & k = cache[n];
+  if (!k) {
+    Slice<uint32_t> keys(n);
+    keys.append_with(n, [](uint32_t * dst, size_t m) {
+      for (size_t i = 0; i < m; ++i) dst[i] = static_cast<uint32_t>(3 * i);
+    });
+    SearchIndex<uint32_t> index(keys);
+    Slice<uint32_t> queries(QUERIES);
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < QUERIES; ++i) {
+      x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+      queries.append(static_cast<uint32_t>(x % (3 * n)));
+    }
+    k = std::make_unique<Keys>(Keys{std::move(keys), std::move(index), std::move(queries)});
+  }
+  return *k;
+}
+
+static void BM_StdLowerBound(benchmark::State & state) {
+  const Keys & k = keys(static_cast<size_t>(state.range(0)));
+  size_t sum = 0;
+  PerfCounters perf;
+  for (auto _ : state) {
+    for (uint32_t q : k.queries)
+      sum += static_cast<size_t>(std::lower_bound(k.keys.begin(), k.keys.end(), q) - k.keys.begin());
+    benchmark::DoNotOptimize(sum);
+  }
+  perf.report(state, static_cast<int64_t>(state.iterations() * QUERIES));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * QUERIES));
+}
+
+static void BM_IndexLowerBound(benchmark::State & state) {
+  const Keys & k = keys(static_cast<size_t>(state.range(0)));
+  size_t sum = 0;
+  PerfCounters perf;
+  for (auto _ : state) {
+    for (uint32_t q : k.queries) sum += k.index.lower_bound(q);
+    benchmark::DoNotOptimize(sum);
+  }
+  perf.report(state, static_cast<int64_t>(state.iterations() * QUERIES));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * QUERIES));
+}
+
+static void BM_IndexLowerBoundBatch(benchmark::State & state) {
+  const Keys & k = keys(static_cast<size_t>(state.range(0)));
+  auto out = std::make_unique<size_t[]>(QUERIES);
+  PerfCounters perf;
+  for (auto _ : state) {
+    k.index.lower_bound(k.queries.data(), QUERIES, out.get());
+    benchmark::DoNotOptimize(out.get());
+    benchmark::ClobberMemory();
+  }
+  perf.report(state, static_cast<int64_t>(state.iterations() * QUERIES));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * QUERIES));
+}
+
+BENCHMARK(BM_StdLowerBound)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK(BM_IndexLowerBound)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK(BM_IndexLowerBoundBatch)->Arg(1'000'000)->Arg(100'000'000);
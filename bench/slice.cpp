@@ -0,0 +1,408 @@
+#include <cppslice.hpp>
+#include <utils/test_classes.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include "perf_counters.hpp"
+
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
+
+/*
+ * Benchmarks of the core `Slice` operations against `std::vector`, `std::array` and `std::span`.
+ * Every benchmark is instantiated for the element types of utils/test_classes.hpp (plus `int` as
+ * a baseline) and run over sizes from 1 to 10^8, reporting the time per operation (latency) and
+ * the elements processed per second (throughput). Operations a container does not support for a
+ * given element type are skipped. The kernels that touch every element also report hardware
+ * counters per element (see perf_counters.hpp), when perf events are available.
+ */
+
+/**
+ * @brief Builds the `i`-th element of a benchmark.
+ */
+template<typename T>
+static T make(int i) {
+  if constexpr (std::is_same_v<T, int>) return i;
+  else if constexpr (std::is_same_v<T, Point>) return Point{i, i};
+  else if constexpr (std::is_same_v<T, NonTriviallyDestructible>) return T();
+  else return T(i);
+}
+
+/**
+ * @brief Appends the `i`-th element to a container, moving it if possible and copying it otherwise.
+ */
+template<typename T>
+static void append(Slice<T> & s, size_t i) {
+  T el = make<T>(static_cast<int>(i));
+  if constexpr (std::move_constructible<T>) s.append(std::move(el));
+  else s.append(el);
+}
+
+template<typename T>
+static void append(std::vector<T> & v, size_t i) {
+  T el = make<T>(static_cast<int>(i));
+  if constexpr (std::move_constructible<T>) v.push_back(std::move(el));
+  else v.push_back(el);
+}
+
+/**
+ * @brief Builds a `std::vector` of `n` elements.
+ */
+template<typename T>
+static std::vector<T> make_vector(size_t n) {
+  std::vector<T> v;
+  v.reserve(n);
+  for (size_t i = 0; i < n; ++i) append(v, i);
+  return v;
+}
+
+/**
+ * @brief Builds a `Slice` of `n` elements.
+ */
+template<typename T>
+static Slice<T> make_slice(size_t n) {
+  Slice<T> s(n);
+  for (size_t i = 0; i < n; ++i) append(s, i);
+  return s;
+}
+
+/**
+ * @brief Returns pseudo-random indices in [0, n), to defeat the prefetchers in access benchmarks.
+ */
+static std::vector<size_t> make_indices(size_t n) {
+  std::vector<size_t> idx(1024);
+  size_t x = 88172645463325252ULL;
+  for (auto & i : idx) x ^= x << 13, x ^= x >> 7, x ^= x << 17, i = x % n;
+  return idx;
+}
+
+static size_t size_of(const benchmark::State & state) { return static_cast<size_t>(state.range(0)); }
+
+// Size construction
+
+template<typename T>
+static void BM_ConstructSize_Slice(benchmark::State & state) {
+  for (auto _ : state) {
+    Slice<T> s(size_of(state));
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_ConstructSize_Vector(benchmark::State & state) {
+  for (auto _ : state) {
+    std::vector<T> v;
+    v.reserve(size_of(state));
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Iterable construction, moving the elements when possible like the `Slice` constructor does
+
+template<typename T>
+static void BM_ConstructIterable_Slice(benchmark::State & state) {
+  auto src = make_vector<T>(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state) {
+    Slice<T> s(src);
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_ConstructIterable_Vector(benchmark::State & state) {
+  auto src = make_vector<T>(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state) {
+    if constexpr (std::move_constructible<T>) {
+      std::vector<T> v(std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+      benchmark::DoNotOptimize(v.data());
+    } else {
+      std::vector<T> v(src.begin(), src.end());
+      benchmark::DoNotOptimize(v.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+// Variadic construction of 8 elements
+
+template<typename T>
+static void BM_ConstructVariadic_Slice(benchmark::State & state) {
+  for (auto _ : state) {
+    Slice<T> s(make<T>(0), make<T>(1), make<T>(2), make<T>(3), make<T>(4), make<T>(5), make<T>(6), make<T>(7));
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 8);
+}
+
+template<typename T>
+static void BM_ConstructVariadic_Vector(benchmark::State & state) {
+  if constexpr (std::is_copy_constructible_v<T>) {
+    for (auto _ : state) {
+      std::vector<T> v{make<T>(0), make<T>(1), make<T>(2), make<T>(3), make<T>(4), make<T>(5), make<T>(6), make<T>(7)};
+      benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+  } else {
+    state.SkipWithError("std::initializer_list needs copyable elements");
+  }
+}
+
+template<typename T>
+static void BM_ConstructVariadic_Array(benchmark::State & state) {
+  for (auto _ : state) {
+    std::array<T, 8> a{make<T>(0), make<T>(1), make<T>(2), make<T>(3), make<T>(4), make<T>(5), make<T>(6), make<T>(7)};
+    benchmark::DoNotOptimize(a.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 8);
+}
+
+// Random element access
+
+template<typename T>
+static void BM_Access_Slice(benchmark::State & state) {
+  auto s = make_slice<T>(size_of(state));
+  const auto idx = make_indices(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state)
+    for (size_t i : idx) benchmark::DoNotOptimize(s[i]);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(idx.size()));
+  perf.report(state, state.iterations() * static_cast<int64_t>(idx.size()));
+}
+
+template<typename T>
+static void BM_Access_Vector(benchmark::State & state) {
+  auto v = make_vector<T>(size_of(state));
+  const auto idx = make_indices(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state)
+    for (size_t i : idx) benchmark::DoNotOptimize(&v[i]);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(idx.size()));
+  perf.report(state, state.iterations() * static_cast<int64_t>(idx.size()));
+}
+
+template<typename T>
+static void BM_Access_Span(benchmark::State & state) {
+  auto v = make_vector<T>(size_of(state));
+  std::span<T> sp(v);
+  const auto idx = make_indices(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state)
+    for (size_t i : idx) benchmark::DoNotOptimize(&sp[i]);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(idx.size()));
+  perf.report(state, state.iterations() * static_cast<int64_t>(idx.size()));
+}
+
+// Sequential iteration
+
+template<typename T>
+static void BM_Iterate_Slice(benchmark::State & state) {
+  auto s = make_slice<T>(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state)
+    for (T & el : s) benchmark::DoNotOptimize(&el);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_Iterate_Vector(benchmark::State & state) {
+  auto v = make_vector<T>(size_of(state));
+  PerfCounters perf;
+  for (auto _ : state)
+    for (T & el : v) benchmark::DoNotOptimize(&el);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_Iterate_Span(benchmark::State & state) {
+  auto v = make_vector<T>(size_of(state));
+  std::span<T> sp(v);
+  PerfCounters perf;
+  for (auto _ : state)
+    for (T & el : sp) benchmark::DoNotOptimize(&el);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+// Sub-slicing the middle half; a `std::vector` has to copy it
+
+template<typename T>
+static void BM_SubSlice_Slice(benchmark::State & state) {
+  const size_t n = size_of(state);
+  if (n < 4) return state.SkipWithError("sub-slicing needs at least 4 elements");
+  auto s = make_slice<T>(n);
+  for (auto _ : state) {
+    Slice<T> sub = s[n / 4, 3 * n / 4];
+    benchmark::DoNotOptimize(sub.data());
+  }
+}
+
+template<typename T>
+static void BM_SubSlice_Span(benchmark::State & state) {
+  const size_t n = size_of(state);
+  if (n < 4) return state.SkipWithError("sub-slicing needs at least 4 elements");
+  auto v = make_vector<T>(n);
+  std::span<T> sp(v);
+  for (auto _ : state) {
+    auto sub = sp.subspan(n / 4, n / 2);
+    benchmark::DoNotOptimize(sub.data());
+  }
+}
+
+template<typename T>
+static void BM_SubSlice_Vector(benchmark::State & state) {
+  const size_t n = size_of(state);
+  if constexpr (std::is_copy_constructible_v<T>) {
+    if (n < 4) return state.SkipWithError("sub-slicing needs at least 4 elements");
+    auto v = make_vector<T>(n);
+    for (auto _ : state) {
+      std::vector<T> sub(v.begin() + static_cast<ptrdiff_t>(n / 4), v.begin() + static_cast<ptrdiff_t>(3 * n / 4));
+      benchmark::DoNotOptimize(sub.data());
+    }
+  } else {
+    state.SkipWithError("copying a range needs copyable elements");
+  }
+}
+
+// Growth by appending one element at a time
+
+template<typename T>
+static void BM_Grow_Slice(benchmark::State & state) {
+  PerfCounters perf;
+  for (auto _ : state) {
+    Slice<T> s;
+    for (size_t i = 0; i < size_of(state); ++i) append(s, i);
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_Grow_Vector(benchmark::State & state) {
+  PerfCounters perf;
+  for (auto _ : state) {
+    std::vector<T> v;
+    for (size_t i = 0; i < size_of(state); ++i) append(v, i);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  perf.report(state, state.iterations() * state.range(0));
+}
+
+// Destruction, timed manually to leave the construction out
+
+template<typename Make>
+static void destroy(benchmark::State & state, Make build) {
+  for (auto _ : state) {
+    auto c = std::make_unique<decltype(build())>(build());
+    auto start = std::chrono::steady_clock::now();
+    c.reset();
+    state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename T>
+static void BM_Destroy_Slice(benchmark::State & state) {
+  destroy(state, [&] { return make_slice<T>(size_of(state)); });
+}
+
+template<typename T>
+static void BM_Destroy_Vector(benchmark::State & state) {
+  destroy(state, [&] { return make_vector<T>(size_of(state)); });
+}
+
+// `std::array` needs its size at compile time, so it is compared on a few fixed sizes
+
+template<typename T, size_t N>
+static void BM_Array_Construct(benchmark::State & state) {
+  for (auto _ : state) {
+    auto a = std::make_unique<std::array<T, N>>();
+    benchmark::DoNotOptimize(a->data());
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+
+template<typename T, size_t N>
+static void BM_Array_Access(benchmark::State & state) {
+  auto a = std::make_unique<std::array<T, N>>();
+  const auto idx = make_indices(N);
+  PerfCounters perf;
+  for (auto _ : state)
+    for (size_t i : idx) benchmark::DoNotOptimize(&(*a)[i]);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(idx.size()));
+  perf.report(state, state.iterations() * static_cast<int64_t>(idx.size()));
+}
+
+template<typename T, size_t N>
+static void BM_Array_Iterate(benchmark::State & state) {
+  auto a = std::make_unique<std::array<T, N>>();
+  PerfCounters perf;
+  for (auto _ : state)
+    for (T & el : *a) benchmark::DoNotOptimize(&el);
+  state.SetItemsProcessed(state.iterations() * N);
+  perf.report(state, state.iterations() * N);
+}
+
+/**
+ * @brief Runs a benchmark over the sizes 1, 100, …, up to `max`.
+ */
+#define SIZES(max) RangeMultiplier(100)->Range(1, max)
+
+#define BENCH_SLICE(T, max)                                                                        \
+  BENCHMARK(BM_ConstructSize_Slice<T>)->SIZES(max);                                                \
+  BENCHMARK(BM_ConstructSize_Vector<T>)->SIZES(max);                                               \
+  BENCHMARK(BM_ConstructIterable_Slice<T>)->SIZES(max);                                            \
+  BENCHMARK(BM_ConstructIterable_Vector<T>)->SIZES(max);                                           \
+  BENCHMARK(BM_ConstructVariadic_Slice<T>);                                                        \
+  BENCHMARK(BM_ConstructVariadic_Vector<T>);                                                       \
+  BENCHMARK(BM_ConstructVariadic_Array<T>);                                                        \
+  BENCHMARK(BM_Access_Slice<T>)->SIZES(max);                                                       \
+  BENCHMARK(BM_Access_Vector<T>)->SIZES(max);                                                      \
+  BENCHMARK(BM_Access_Span<T>)->SIZES(max);                                                        \
+  BENCHMARK(BM_Iterate_Slice<T>)->SIZES(max);                                                      \
+  BENCHMARK(BM_Iterate_Vector<T>)->SIZES(max);                                                     \
+  BENCHMARK(BM_Iterate_Span<T>)->SIZES(max);                                                       \
+  BENCHMARK(BM_SubSlice_Slice<T>)->SIZES(max);                                                     \
+  BENCHMARK(BM_SubSlice_Span<T>)->SIZES(max);                                                      \
+  BENCHMARK(BM_SubSlice_Vector<T>)->SIZES(max);                                                    \
+  BENCHMARK(BM_Grow_Slice<T>)->SIZES(max);                                                         \
+  BENCHMARK(BM_Grow_Vector<T>)->SIZES(max);                                                        \
+  BENCHMARK(BM_Destroy_Slice<T>)->SIZES(max)->UseManualTime();                                     \
+  BENCHMARK(BM_Destroy_Vector<T>)->SIZES(max)->UseManualTime()
+
+#define BENCH_ARRAY(T)                                                                             \
+  BENCHMARK(BM_Array_Construct<T, 1>);                                                             \
+  BENCHMARK(BM_Array_Construct<T, 100>);                                                           \
+  BENCHMARK(BM_Array_Construct<T, 10000>);                                                         \
+  BENCHMARK(BM_Array_Access<T, 1>);                                                                \
+  BENCHMARK(BM_Array_Access<T, 100>);                                                              \
+  BENCHMARK(BM_Array_Access<T, 10000>);                                                            \
+  BENCHMARK(BM_Array_Iterate<T, 1>);                                                               \
+  BENCHMARK(BM_Array_Iterate<T, 100>);                                                             \
+  BENCHMARK(BM_Array_Iterate<T, 10000>)
+
+// Trivial element types go up to 10^8 elements; the others allocate or lock, and stop at 10^6
+BENCH_SLICE(int, 100'000'000);
+BENCH_SLICE(Point, 100'000'000);
+BENCH_SLICE(OnlyMovable, 1'000'000);
+BENCH_SLICE(OnlyCopyable, 1'000'000);
+BENCH_SLICE(NonTriviallyDestructible, 1'000'000);
+
+// `std::array` needs default-constructible elements
+BENCH_ARRAY(int);
+BENCH_ARRAY(Point);
+BENCH_ARRAY(NonTriviallyDestructible);
@@ -0,0 +1,113 @@
+#include <stream.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * Benchmarks of the streaming stores of stream.hpp against regular stores (`std::memcpy` and
+ * `std::fill_n`), for buffers from a fraction to several times the LLC.
+ *
+ * The bandwidth benchmarks report the bytes written per second. The pollution benchmarks run a
+ * cache-resident workload (random reads over a quarter of the LLC) while another thread keeps
+ * copying a buffer four times the LLC, and report the time and LLC misses per read of the
+ * workload: regular stores evict its working set, streaming stores leave it in the cache.
+ */
+
+enum class Store { Regular, Streaming };
+
+/**
+ * @brief Returns a buffer of `bytes` bytes, zeroed so that its pages are mapped.
+ */
+static std::unique_ptr<unsigned char[]> make_buffer(size_t bytes) { return std::make_unique<unsigned char[]>(bytes); }
+
+/**
+ * @brief Copies `bytes` bytes from `src` to `dst` with `Store`s.
+ */
+template<Store S>
+static void copy(unsigned char * dst, const unsigned char * src, size_t bytes) {
+  if constexpr (S == Store::Streaming) StreamStore::copy(dst, src, bytes);
+  else std::memcpy(dst, src, bytes);
+}
+
+/**
+ * @brief Adds the sizes of the bandwidth benchmarks, in eighths of the LLC, from 1/8 to 4 LLCs.
+ */
+static void llc_fractions(benchmark::internal::Benchmark * b) {
+  for (int eighths : {1, 4, 8, 16, 32}) b->Arg(eighths);
+}
+
+/**
+ * @brief Returns the bytes of a bandwidth benchmark.
+ */
+static size_t llc_eighths(const benchmark::State & state) {
+  return StreamStore::llc_bytes() / 8 * static_cast<size_t>(std::clamp<int64_t>(state.range(0), 1, 64));
+}
+
+template<Store S>
+static void BM_Copy(benchmark::State & state) {
+  const size_t bytes = llc_eighths(state);
+  auto src = make_buffer(bytes), dst = make_buffer(bytes);
+  for (auto _ : state) {
+    copy<S>(dst.get(), src.get(), bytes);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+  state.counters["LLC"] = static_cast<double>(state.range(0)) / 8;
+}
+
+template<Store S>
+static void BM_Fill(benchmark::State & state) {
+  const size_t n = llc_eighths(state) / sizeof(uint64_t);
+  auto dst = std::make_unique<uint64_t[]>(n);
+  for (auto _ : state) {
+    if constexpr (S == Store::Streaming) StreamStore::fill(dst.get(), n, uint64_t(42));
+    else std::fill_n(dst.get(), n, uint64_t(42));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(uint64_t)));
+  state.counters["LLC"] = static_cast<double>(state.range(0)) / 8;
+}
+
+template<Store S>
+static void BM_Pollution(benchmark::State & state) {
+  constexpr size_t READS = size_t(1) << 16;
+  const size_t llc = StreamStore::llc_bytes();
+  const size_t n = llc / 4 / sizeof(uint64_t), bytes = 4 * llc;
+  auto work = std::make_unique<uint64_t[]>(n);
+  for (size_t i = 0; i < n; ++i) work[i] = i;
+  auto src = make_buffer(bytes), dst = make_buffer(bytes);
+
+  std::atomic<bool> stop = false;
+  std::jthread copier([&] {
+    while (!stop.load(std::memory_order_relaxed)) copy<S>(dst.get(), src.get(), bytes);
+  });
+
+  uint64_t x = 88172645463325252ULL, sum = 0;
+  PerfCounters perf;
+  for (auto _ : state) {
+    for (size_t r = 0; r < READS; ++r) {
+      x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+      sum += work[x % n];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  perf.report(state, static_cast<int64_t>(state.iterations() * READS));
+  stop = true;
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * READS));
+}
+
+BENCHMARK(BM_Copy<Store::Regular>)->Apply(llc_fractions);
+BENCHMARK(BM_Copy<Store::Streaming>)->Apply(llc_fractions);
+BENCHMARK(BM_Fill<Store::Regular>)->Apply(llc_fractions);
+BENCHMARK(BM_Fill<Store::Streaming>)->Apply(llc_fractions);
+BENCHMARK(BM_Pollution<Store::Regular>)->UseRealTime();
+BENCHMARK(BM_Pollution<Store::Streaming>)->UseRealTime();
@@ -0,0 +1,278 @@
+#ifndef AGGREGATED_SLICE_HXX
+#define AGGREGATED_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief The sum of elements, with `T()` as its identity.
+ */
+template<typename T>
+struct SumOp {
+  static constexpr T identity() noexcept { return T(); }
+  constexpr T operator()(const T & a, const T & b) const { return a + b; }
+};
+
+/**
+ * @brief The minimum of elements, with the largest value (or infinity) as its identity.
+ */
+template<typename T>
+struct MinOp {
+  static constexpr T identity() noexcept {
+    if constexpr (std::numeric_limits<T>::has_infinity) return std::numeric_limits<T>::infinity();
+    else return std::numeric_limits<T>::max();
+  }
+  constexpr T operator()(const T & a, const T & b) const { return b < a ? b : a; }
+};
+
+/**
+ * @brief The maximum of elements, with the lowest value (or minus infinity) as its identity.
+ */
+template<typename T>
+struct MaxOp {
+  static constexpr T identity() noexcept {
+    if constexpr (std::numeric_limits<T>::has_infinity) return -std::numeric_limits<T>::infinity();
+    else return std::numeric_limits<T>::lowest();
+  }
+  constexpr T operator()(const T & a, const T & b) const { return a < b ? b : a; }
+};
+
+/**
+ * @brief An associative operation over `T` with an identity, e.g. `SumOp`, `MinOp` or `MaxOp`.
+ */
+template<typename Op, typename T>
+concept AggregateOp = std::default_initializable<Op> && requires(const Op & op, const T & a) {
+  { Op::identity() } -> std::convertible_to<T>;
+  { op(a, a) } -> std::convertible_to<T>;
+};
+
+/**
+ * @class AggregatedSlice
+ * @brief An appendable collection answering range aggregates (sums, minima, …) in O(log n).
+ *
+ * An `AggregatedSlice` keeps, alongside its elements, the internal nodes of an implicit
+ * bottom-up segment tree over them: node p aggregates its children 2p and 2p + 1, the root is
+ * node 1, and the elements are the leaves, as nodes `leaves_` to `2 * leaves_ - 1` (past the
+ * last element, leaves are the identity). Updating an element recomputes its ancestors, and a
+ * range aggregate combines the O(log n) nodes covering the range, in order, so that `Op` need
+ * not be commutative.
+ *
+ * The nodes are stored level by level (level k is nodes 2^k to 2^{k+1} - 1), in cache lines, so
+ * that every level of at least a line starts on a line: rebuilding a level is a loop over
+ * contiguous pairs of children, which compilers vectorize. Bulk appends rebuild the affected
+ * nodes level by level, in O(k + log n) for k elements, and growing past a power of two rebuilds
+ * the whole tree, in amortized O(1) per element.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Op The aggregate, associative with an identity.
+ */
+template<typename T, typename Op = SumOp<T>>
+requires std::is_trivially_copyable_v<T> && std::default_initializable<T> && AggregateOp<Op, T>
+class AggregatedSlice {
+private:
+
+  /// The nodes per cache line, or 1 if `T` does not divide a line.
+  static constexpr size_t W = 64 % sizeof(T) == 0 ? 64 / sizeof(T) : 1;
+
+  /**
+   * @brief A cache line of nodes.
+   */
+  struct alignas(W > 1 ? 64 : alignof(T)) Line {
+    T v[W]; ///< The nodes.
+  };
+
+  static_assert(sizeof(Line) == W * sizeof(T), "Lines must hold nodes without padding.");
+
+  Slice<T> data_;     ///< The elements.
+  Slice<Line> tree_;  ///< The internal nodes, node p at `nodes()[p]`; node 0 is unused.
+  size_t leaves_;     ///< The number of leaves, a power of two.
+  [[no_unique_address]] Op op_; ///< The aggregate.
+
+  /*–
+   * AF: the sequence [data_[0], …, data_[n - 1]], where n = data_.size().
+   *
+   * ---
+   *
+   * RI: - leaves_ is a power of two, leaves_ ≥ max(W, 2) and leaves_ ≥ n
+   *     - tree_.size() = leaves_ / W
+   *     - node(p) = op_(node(2p), node(2p + 1)) for 1 ≤ p < leaves_, where node(leaves_ + i) is
+   *       data_[i] if i < n and the identity otherwise
+   */
+
+  T * nodes() noexcept { return tree_.data()->v; }
+  const T * nodes() const noexcept { return tree_.data()->v; }
+
+  /**
+   * @brief Returns node `p`, an internal node or a leaf.
+   */
+  T node(size_t p) const noexcept {
+    if (p < leaves_) return nodes()[p];
+    p -= leaves_;
+    return p < data_.size() ? data_.data()[p] : Op::identity();
+  }
+
+  /**
+   * @brief Recomputes the ancestors of the leaves `[lo, hi)`, level by level.
+   */
+  void rebuild(size_t lo, size_t hi) {
+    if (lo >= hi) return;
+    T * t = nodes();
+    const T * d = data_.data();
+    size_t a = (leaves_ + lo) / 2, b = (leaves_ + hi - 1) / 2 + 1;
+    // the lowest level, whose children are elements, while both children exist
+    const size_t full = std::min(b, (leaves_ + data_.size()) / 2);
+    size_t p = a;
+    for (; p < full; ++p) t[p] = op_(d[2 * p - leaves_], d[2 * p + 1 - leaves_]);
+    for (; p < b; ++p) t[p] = op_(node(2 * p), node(2 * p + 1));
+    for (a /= 2, b = (b - 1) / 2 + 1; a > 0; a /= 2, b = (b - 1) / 2 + 1)
+      for (p = a; p < b; ++p) t[p] = op_(t[2 * p], t[2 * p + 1]);
+  }
+
+  /**
+   * @brief Replaces the tree with one of `leaves` leaves, built from scratch.
+   */
+  void regrow(size_t leaves) {
+    Slice<Line> tree(leaves / W);
+    tree.append_with(leaves / W, [](Line * dst, size_t n) {
+      for (size_t i = 0; i < n; ++i) {
+        Line * l = new (dst + i) Line;
+        std::fill_n(l->v, W, T(Op::identity()));
+      }
+    });
+    tree_ = std::move(tree);
+    leaves_ = leaves;
+    rebuild(0, data_.size());
+  }
+
+  /**
+   * @brief Restores the tree after the elements from `from` changed, growing it if needed.
+   */
+  void changed(size_t from) {
+    if (data_.size() > leaves_) regrow(std::bit_ceil(data_.size()));
+    else rebuild(from, data_.size());
+  }
+
+  void check(size_t i) const {
+    if (i >= data_.size()) throw std::out_of_range("Invalid argument");
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  explicit AggregatedSlice(Op op = Op()) : data_(), tree_(), leaves_(0), op_(std::move(op)) {
+    regrow(std::max<size_t>(W, 2));
+  }
+
+  /**
+   * @brief Slice constructor.
+   *
+   * Creates `this` holding a copy of the elements of `s`, building the tree in O(n).
+   */
+  explicit AggregatedSlice(const Slice<T> & s, Op op = Op()) : data_(s.size()), tree_(), leaves_(0), op_(std::move(op)) {
+    data_.append(s.data(), s.size());
+    regrow(std::bit_ceil(std::max({s.size(), W, size_t(2)})));
+  }
+
+  /**
+   * @brief Returns the number of elements.
+   */
+  size_t size() const noexcept { return data_.size(); }
+
+  /**
+   * @brief Returns the elements, read-only, e.g. to hand them to other `Slice` algorithms.
+   */
+  const Slice<T> & data() const noexcept { return data_; }
+
+  const T * begin() const noexcept { return data_.data(); }
+  const T * end() const noexcept { return data_.data() + data_.size(); }
+
+  /**
+   * @brief Subscript operator.
+   *
+   * @return A pointer to the element at index `i`, read-only: elements change through `set()`.
+   *
+   * @throws out_of_range If the index is out of bounds.
+   */
+  const T * operator[](size_t i) const {
+    check(i);
+    return data_.data() + i;
+  }
+
+  /**
+   * @brief Replaces the element at index `i` with `v`, in O(log n).
+   *
+   * @throws out_of_range If the index is out of bounds.
+   */
+  void set(size_t i, const T & v) {
+    check(i);
+    data_.data()[i] = v;
+    T * t = nodes();
+    for (size_t p = (leaves_ + i) / 2; p > 0; p /= 2) t[p] = op_(node(2 * p), node(2 * p + 1));
+  }
+
+  /**
+   * @brief Appends `v`, in amortized O(log n).
+   */
+  void append(const T & v) {
+    const T el = v;  // `v` may be an element of `this`
+    data_.append(el);
+    changed(data_.size() - 1);
+  }
+
+  /**
+   * @brief Appends copies of `n` elements, rebuilding the tree once, in amortized O(n + log size).
+   *
+   * The elements must not alias an element of `this`.
+   */
+  void append(const T * src, size_t n) {
+    const size_t from = data_.size();
+    data_.append(src, n);
+    changed(from);
+  }
+
+  /**
+   * @brief Shrinks `this` to its first `n` elements, keeping the capacity.
+   */
+  void truncate(size_t n) {
+    const size_t len = data_.size();
+    if (n >= len) return;
+    data_.truncate(n);
+    rebuild(n, len);
+  }
+
+  /**
+   * @brief Returns the aggregate of the elements `[l, r)`, in O(log n), or the identity if the
+   *        range is empty.
+   *
+   * @throws out_of_range If the range is invalid.
+   */
+  T query(size_t l, size_t r) const {
+    if (l > r || r > data_.size()) throw std::out_of_range("Invalid argument");
+    T left = Op::identity(), right = Op::identity();
+    for (l += leaves_, r += leaves_; l < r; l /= 2, r /= 2) {
+      if (l & 1) left = op_(left, node(l++));
+      if (r & 1) right = op_(node(--r), right);
+    }
+    return op_(left, right);
+  }
+
+  /**
+   * @brief Returns the aggregate of every element, in O(1).
+   */
+  T total() const noexcept { return nodes()[1]; }
+};
+
+#endif // AGGREGATED_SLICE_HXX
@@ -0,0 +1,308 @@
+#ifndef ALLOC_TRACE_HXX
+#define ALLOC_TRACE_HXX
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+/**
+ * @brief The kinds of allocation events of `Slice`.
+ */
+enum class AllocKind : uint8_t {
+  Alloc, ///< A chunk of data was allocated.
+  Free,  ///< A chunk of data was freed.
+  Grow   ///< A collection was reallocated to a larger capacity; the event spans the whole copy.
+};
+
+/**
+ * @brief An allocation event, as recorded by a thread.
+ */
+struct AllocEvent {
+  uint64_t ts;                  ///< The time of the event, in nanoseconds since the tracer started.
+  uint64_t dur;                 ///< The duration of a `Grow`, in nanoseconds; 0 otherwise.
+  uint64_t bytes;               ///< The size of the chunk, or the new size of a `Grow`.
+  uint64_t from;                ///< The old size of a `Grow`, in bytes; 0 otherwise.
+  const void * ptr;             ///< The address of the chunk.
+  const std::type_info * type;  ///< The type of the elements.
+  AllocKind kind;               ///< The kind of the event.
+};
+
+/**
+ * @class AllocTracer
+ * @brief The process-wide collection of per-thread `Slice` allocation events.
+ *
+ * Every thread appends its events to its own log, a list of fixed-size chunks that only it
+ * writes: recording is a plain store followed by a release store of the chunk count, without
+ * locks or read-modify-write operations, and only the first event of a thread (and of every
+ * chunk) allocates. `flush()` reads the published events of every thread, including the ones
+ * that exited, and writes them as Chrome trace-event JSON, which can be opened in Perfetto or
+ * `chrome://tracing`: allocations and frees are instant events, growths are complete events
+ * spanning the relocation, and the live heap of `Slice`s is drawn as a counter track.
+ * The logs are intentionally leaked, so that slices destroyed during static destruction can
+ * still be traced.
+ *
+ * @note For more information about the format, refer to the
+ *       [Trace Event Format](https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU).
+ */
+class AllocTracer {
+private:
+
+  /**
+   * @brief A chunk of the events of a thread.
+   */
+  struct Chunk {
+    static constexpr size_t N = 4096; ///< The events per chunk.
+
+    AllocEvent events[N];             ///< The events, published up to `count`.
+    std::atomic<size_t> count{0};     ///< The number of published events.
+    std::atomic<Chunk *> next{nullptr}; ///< The following chunk, once this one is full.
+  };
+
+  /**
+   * @brief The event log of a thread.
+   */
+  struct Log {
+    uint32_t tid;  ///< The identifier of the thread, as reported.
+    Chunk * head;  ///< The first chunk, read by `flush()`.
+    Chunk * tail;  ///< The chunk being written, only accessed by the owner.
+  };
+
+  /**
+   * @brief The registry of the logs of every thread that recorded an event.
+   */
+  struct Registry {
+    std::mutex mutex{};        ///< Guards `logs`.
+    std::vector<Log *> logs{}; ///< The logs of every thread, alive or not.
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now(); ///< The time 0 of the events.
+  };
+
+  static Registry & registry() {
+    static Registry * r = new Registry();
+    return *r;
+  }
+
+  static Log & local() {
+    thread_local Log * l = [] {
+      Log * log = new Log{0, new Chunk(), nullptr};
+      log->tail = log->head;
+      std::lock_guard lock(registry().mutex);
+      log->tid = static_cast<uint32_t>(registry().logs.size() + 1);
+      registry().logs.push_back(log);
+      return log;
+    }();
+    return *l;
+  }
+
+  /**
+   * @brief Returns the readable name of a type.
+   */
+  static std::string type_name(const std::type_info & t) {
+    std::string name = t.name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    if (char * d = abi::__cxa_demangle(t.name(), nullptr, nullptr, &status)) name = d, std::free(d);
+#endif
+    return name;
+  }
+
+  /**
+   * @brief Escapes `s` to be embedded in a JSON string.
+   */
+  static std::string escape(const std::string & s) {
+    std::string out;
+    for (char c : s) {
+      if (c == '"' || c == '\\') out += '\\', out += c;
+      else if (static_cast<unsigned char>(c) < 0x20) out += std::format("\\u{:04x}", c);
+      else out += c;
+    }
+    return out;
+  }
+
+public:
+
+  /**
+   * @brief Returns the time elapsed since the tracer started, in nanoseconds.
+   */
+  static uint64_t now() noexcept {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch);
+    return static_cast<uint64_t>(ns.count());
+  }
+
+  /**
+   * @brief Records an event of the calling thread.
+   *
+   * @param e The event.
+   *
+   * @throws std::bad_alloc If the first event of the thread or of a new chunk cannot be stored.
+   */
+  static void record(const AllocEvent & e) {
+    Log & l = local();
+    size_t n = l.tail->count.load(std::memory_order_relaxed);
+    if (n == Chunk::N) {
+      Chunk * c = new Chunk();
+      l.tail->next.store(c, std::memory_order_release);
+      l.tail = c, n = 0;
+    }
+    l.tail->events[n] = e;
+    l.tail->count.store(n + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Records an allocation or a free of the calling thread, dropping it if it cannot be stored.
+   *
+   * @param kind The kind of the event.
+   * @param ptr The address of the chunk.
+   * @param bytes The size of the chunk.
+   * @param type The type of the elements.
+   */
+  static void record(AllocKind kind, const void * ptr, uint64_t bytes, const std::type_info & type) noexcept {
+    try {
+      record(AllocEvent{now(), 0, bytes, 0, ptr, &type, kind});
+    } catch (...) {
+      // Tracing must not make an allocation fail.
+    }
+  }
+
+  /**
+   * @brief Returns the number of events published by every thread so far.
+   */
+  static size_t count() {
+    std::lock_guard lock(registry().mutex);
+    size_t n = 0;
+    for (Log * l : registry().logs)
+      for (Chunk * c = l->head; c; c = c->next.load(std::memory_order_acquire))
+        n += c->count.load(std::memory_order_acquire);
+    return n;
+  }
+
+  /**
+   * @brief Forgets every recorded event.
+   *
+   * Must not race with recording threads.
+   */
+  static void reset() {
+    std::lock_guard lock(registry().mutex);
+    for (Log * l : registry().logs) {
+      for (Chunk * c = l->head->next.load(std::memory_order_acquire), * d; c; c = d)
+        d = c->next.load(std::memory_order_acquire), delete c;
+      l->head->next.store(nullptr, std::memory_order_relaxed);
+      l->head->count.store(0, std::memory_order_release);
+      l->tail = l->head;
+    }
+  }
+
+  /**
+   * @brief Writes the events published by every thread so far as Chrome trace-event JSON.
+   *
+   * Events may be recorded concurrently; the ones published after the logs are read are left out.
+   *
+   * @param os The stream to write to.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  static void flush(std::ostream & os) {
+    struct Tagged {
+      AllocEvent e;
+      uint32_t tid;
+    };
+    std::vector<Tagged> events;
+    {
+      std::lock_guard lock(registry().mutex);
+      for (Log * l : registry().logs)
+        for (Chunk * c = l->head; c; c = c->next.load(std::memory_order_acquire)) {
+          size_t n = c->count.load(std::memory_order_acquire);
+          for (size_t i = 0; i < n; ++i) events.push_back({c->events[i], l->tid});
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Tagged & l, const Tagged & r) { return l.e.ts < r.e.ts; });
+
+    std::vector<std::pair<const std::type_info *, std::string>> names;
+    auto name_of = [&](const std::type_info * t) -> const std::string & {
+      for (auto & [type, name] : names)
+        if (*type == *t) return name;
+      return names.emplace_back(t, escape(type_name(*t))).second;
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    os << R"({"ph":"M","pid":1,"name":"process_name","args":{"name":"Slice allocations"}})";
+    int64_t live = 0;
+    for (const auto & [e, tid] : events) {
+      const std::string & type = name_of(e.type);
+      const double ts = static_cast<double>(e.ts) / 1000;
+      switch (e.kind) {
+      case AllocKind::Alloc:
+      case AllocKind::Free:
+        live += e.kind == AllocKind::Alloc ? static_cast<int64_t>(e.bytes) : -static_cast<int64_t>(e.bytes);
+        os << std::format(",\n{{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"cat\":\"slice\","
+         "\"name\":\"{}\",\"args\":{{\"type\":\"{}\",\"bytes\":{},\"ptr\":\"{}\"}}}}", tid, ts,
+         e.kind == AllocKind::Alloc ? "alloc" : "free", type, e.bytes, e.ptr);
+        os << std::format(",\n{{\"ph\":\"C\",\"pid\":1,\"ts\":{:.3f},\"name\":\"live bytes\",\"args\":{{\"bytes\":{}}}}}",
+         ts, live);
+        break;
+      case AllocKind::Grow:
+        os << std::format(",\n{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"cat\":\"slice\","
+         "\"name\":\"grow\",\"args\":{{\"type\":\"{}\",\"from\":{},\"to\":{}}}}}", tid, ts,
+         static_cast<double>(e.dur) / 1000, type, e.from, e.bytes);
+        break;
+      }
+    }
+    os << "\n]}\n";
+  }
+
+  /**
+   * @brief Writes the events published by every thread so far to the file `path`.
+   *
+   * @throws std::runtime_error If the file cannot be written.
+   */
+  static void flush(const std::string & path) {
+    std::ofstream os(path);
+    if (!os) throw std::runtime_error("AllocTracer: cannot open " + path);
+    flush(os);
+    if (!os) throw std::runtime_error("AllocTracer: cannot write " + path);
+  }
+};
+
+/**
+ * @class AllocGrowScope
+ * @brief Records the time spent in a scope as the growth of a `Slice`.
+ */
+class AllocGrowScope {
+private:
+
+  const std::type_info & type_; ///< The type of the elements.
+  uint64_t from_;               ///< The old size of the collection, in bytes.
+  uint64_t to_;                 ///< The new size of the collection, in bytes.
+  uint64_t start_;              ///< The time the scope was entered.
+
+public:
+
+  AllocGrowScope(const std::type_info & type, uint64_t from, uint64_t to) noexcept
+      : type_(type), from_(from), to_(to), start_(AllocTracer::now()) {}
+
+  AllocGrowScope(const AllocGrowScope &) = delete;
+  AllocGrowScope & operator=(const AllocGrowScope &) = delete;
+
+  ~AllocGrowScope() noexcept {
+    try {
+      AllocTracer::record(AllocEvent{start_, AllocTracer::now() - start_, to_, from_, nullptr, &type_, AllocKind::Grow});
+    } catch (...) {
+      // Tracing must not make a growth fail.
+    }
+  }
+};
+
+#endif // ALLOC_TRACE_HXX
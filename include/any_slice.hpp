@@ -0,0 +1,405 @@
+#ifndef ANY_SLICE_HXX
+#define ANY_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <istream>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Returns the name of `T`, as spelled by the compiler, without RTTI.
+ */
+template<typename T>
+constexpr std::string_view slice_type_name() noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+  std::string_view s = __PRETTY_FUNCTION__;
+  const size_t b = s.find("T = ") + 4;
+  return s.substr(b, s.find_first_of(";]", b) - b);
+#else
+  return "?";
+#endif
+}
+
+/**
+ * @brief The runtime descriptor of the element type of an `AnySlice`.
+ *
+ * A `SliceType` holds everything `AnySlice` needs to manage elements it knows nothing about at
+ * compile time: their size and alignment, and the few operations that depend on their type,
+ * as plain function pointers so that the descriptor can cross plugin boundaries.
+ * `relocate` is `nullptr` for trivially copyable types, which are relocated with `memcpy`;
+ * `destroy` is `nullptr` for trivially destructible types; `copy` and `format` are `nullptr`
+ * when the type is not copyable or not formattable.
+ */
+struct SliceType {
+  std::string_view name; ///< The name of the type.
+  size_t size;           ///< `sizeof` the type.
+  size_t align;          ///< `alignof` the type.
+  bool trivial;          ///< Whether the type is trivially copyable.
+
+  void (*relocate)(void * dst, void * src, size_t n);        ///< Moves n elements, destroying the sources.
+  void (*destroy)(void * p, size_t n) noexcept;              ///< Destroys n elements, in reverse order.
+  void (*copy)(void * dst, const void * src, size_t n);      ///< Copy-constructs n elements.
+  void (*format)(std::string & out, const void * p);         ///< Appends the formatted element to `out`.
+
+  /**
+   * @brief Returns the descriptor of `T`.
+   */
+  template<typename T>
+  requires std::is_nothrow_destructible_v<T> && (!std::is_reference_v<T>)
+  static const SliceType & of() noexcept {
+    static constexpr SliceType t = {
+     slice_type_name<T>(), sizeof(T), alignof(T), std::is_trivially_copyable_v<T>,
+     std::is_trivially_copyable_v<T> ? nullptr : +[](void * dst, void * src, size_t n) {
+       Slice<T>::relocate(static_cast<T *>(dst), static_cast<T *>(src), n);
+     },
+     std::is_trivially_destructible_v<T> ? nullptr : +[](void * p, size_t n) noexcept {
+       for (size_t i = n; i > 0; --i) static_cast<T *>(p)[i - 1].~T();
+     },
+     copy_fn<T>(), format_fn<T>()};
+    return t;
+  }
+
+  /**
+   * @brief Checks whether `this` and `o` describe the same type.
+   *
+   * Descriptors of the same type instantiated in different binaries (e.g. a plugin) are distinct
+   * objects, so they are compared by name and layout when their addresses differ.
+   */
+  bool same(const SliceType & o) const noexcept {
+    return this == &o || (name == o.name && size == o.size && align == o.align);
+  }
+
+private:
+
+  template<typename T>
+  static constexpr auto copy_fn() noexcept -> void (*)(void *, const void *, size_t) {
+    if constexpr (std::is_copy_constructible_v<T>)
+      return [](void * dst, const void * src, size_t n) {
+        std::uninitialized_copy_n(static_cast<const T *>(src), n, static_cast<T *>(dst));
+      };
+    else return nullptr;
+  }
+
+  template<typename T>
+  static constexpr auto format_fn() noexcept -> void (*)(std::string &, const void *) {
+    if constexpr (std::formattable<T, char>)
+      return [](std::string & out, const void * p) { out += std::format("{}\n", *static_cast<const T *>(p)); };
+    else return nullptr;
+  }
+};
+
+/**
+ * @class AnySlice
+ * @brief A type-erased `Slice`, whose element type is only known at runtime.
+ *
+ * An `AnySlice` stores its elements in untyped storage described by a `SliceType`, so that
+ * a single, non-template implementation of its operations (growth, sub-slicing, relocation,
+ * serialization, formatting) serves every element type, and slices can be passed through
+ * interfaces that cannot be templates, such as a plugin ABI. `as<T>()` gives a typed view over
+ * the elements; it costs a comparison of descriptors and no copy.
+ * Like `Slice`, an `AnySlice` either owns its collection or views one (its sub-slices).
+ */
+class AnySlice {
+private:
+
+  static constexpr uint64_t MAGIC = 0x45434953594e41;   ///< "ANYSICE", the serialization tag.
+  static constexpr uint32_t VERSION = 1;                ///< The serialization format version.
+  static constexpr size_t LOAD_CHUNK = size_t(1) << 20; ///< The bytes `load()` reads before growing.
+
+  const SliceType * type_; ///< The type of the elements.
+  std::byte * arr_;        ///< The collection of elements in `this`.
+  size_t len_;             ///< The number of elements currently in `this`.
+  size_t cap_;             ///< The maximum capacity of `this`.
+  bool own_;               ///< Whether `this` owns `arr_`, rather than viewing another collection.
+
+  /*–
+   * AF: the `Slice` of elements of type `*type_` [arr_[0], …, arr_[len_ - 1]], each one taking
+   *     `type_->size` bytes, with capacity `cap_`.
+   *
+   * ---
+   *
+   * RI: - type_ ≠ nullptr
+   *     - 0 ≤ len_ ≤ cap_
+   *     - arr_ = nullptr ⇔ cap_ = 0
+   *     - arr_ is aligned to type_->align
+   */
+
+  bool overaligned() const noexcept { return type_->align > __STDCPP_DEFAULT_NEW_ALIGNMENT__; }
+
+  std::byte * at(size_t i) const noexcept { return arr_ + i * type_->size; }
+
+  /**
+   * @brief Allocates an uninitialized chunk of data for `cap` elements.
+   */
+  std::byte * raw_allocate(size_t cap) const {
+    if (cap > SIZE_MAX / type_->size) throw std::bad_array_new_length();
+    if (overaligned()) return static_cast<std::byte *>(::operator new[](cap * type_->size, std::align_val_t(type_->align)));
+    return static_cast<std::byte *>(::operator new[](cap * type_->size));
+  }
+
+  /**
+   * @brief Frees a chunk of data obtained from `raw_allocate()`.
+   */
+  void raw_deallocate(std::byte * brr) const noexcept {
+    if (overaligned()) ::operator delete[](brr, std::align_val_t(type_->align));
+    else ::operator delete[](brr);
+  }
+
+  /**
+   * @brief Destroys the elements of `this` and frees its collection, if it owns them.
+   */
+  void release() noexcept {
+    if (arr_ && own_) {
+      if (type_->destroy) type_->destroy(arr_, len_);
+      raw_deallocate(arr_);
+    }
+    arr_ = nullptr, len_ = 0, cap_ = 0, own_ = true;
+  }
+
+  /**
+   * @brief Checks that the elements of `this` are of type `t`.
+   *
+   * @throws std::invalid_argument If they are not.
+   */
+  void expect(const SliceType & t) const {
+    if (!type_->same(t))
+      throw std::invalid_argument(std::format("AnySlice holds {}, not {}.", type_->name, t.name));
+  }
+
+public:
+
+  /**
+   * @brief Type constructor.
+   *
+   * Creates an empty `this` with elements of type `type` and capacity `cap`.
+   */
+  explicit AnySlice(const SliceType & type, size_t cap = 0)
+      : type_(&type), arr_(nullptr), len_(0), cap_(0), own_(true) {
+    reserve(cap);
+  }
+
+  /**
+   * @brief `Slice` constructor.
+   *
+   * Creates `this` by moving the elements of `s` into untyped storage, in one pass (a `memcpy`
+   * when they are trivially copyable).
+   */
+  template<typename T>
+  explicit AnySlice(Slice<T> && s) : AnySlice(SliceType::of<T>(), s.size()) {
+    if (s.size() == 0) return;
+    if (type_->trivial) std::memcpy(arr_, s.data(), s.size() * sizeof(T));
+    else std::uninitialized_move_n(s.begin(), s.size(), reinterpret_cast<T *>(arr_));
+    len_ = s.size();
+  }
+
+  AnySlice(const AnySlice &) = delete;
+  AnySlice & operator=(const AnySlice &) = delete;
+
+  AnySlice(AnySlice && o) noexcept : type_(o.type_), arr_(o.arr_), len_(o.len_), cap_(o.cap_), own_(o.own_) {
+    o.arr_ = nullptr, o.len_ = 0, o.cap_ = 0, o.own_ = true;
+  }
+
+  AnySlice & operator=(AnySlice && o) noexcept {
+    if (this != &o) {
+      release();
+      type_ = o.type_, arr_ = o.arr_, len_ = o.len_, cap_ = o.cap_, own_ = o.own_;
+      o.arr_ = nullptr, o.len_ = 0, o.cap_ = 0, o.own_ = true;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Returns the type of the elements of `this`.
+   */
+  const SliceType & type() const noexcept { return *type_; }
+
+  size_t size() const noexcept { return len_; }
+
+  size_t capacity() const noexcept { return cap_; }
+
+  void * data() noexcept { return arr_; }
+
+  const void * data() const noexcept { return arr_; }
+
+  /**
+   * @brief Returns a pointer to the element at position `i`.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  void * operator[](size_t i) const {
+    if (i >= len_) throw std::out_of_range("Invalid argument");
+    return at(i);
+  }
+
+  /**
+   * @brief Returns the sub-slice [i, f) of `this`, as a view that neither destroys nor frees.
+   *
+   * @throws std::out_of_range If [i, f) is not a valid range of `this`.
+   */
+  AnySlice operator[](size_t i, size_t f) const {
+    if (i > f || f > len_) throw std::out_of_range("Invalid argument");
+    AnySlice s(*type_);
+    s.arr_ = f > i ? at(i) : nullptr, s.len_ = s.cap_ = f - i, s.own_ = false;
+    return s;
+  }
+
+  /**
+   * @brief Returns a typed view over the elements of `this`.
+   *
+   * The view neither destroys nor frees the elements, and must not outlive `this`.
+   *
+   * @throws std::invalid_argument If the elements of `this` are not of type `T`.
+   */
+  template<typename T>
+  Slice<T> as() const {
+    expect(SliceType::of<T>());
+    return Slice<T>(reinterpret_cast<T *>(arr_), len_);
+  }
+
+  /**
+   * @brief Grows the capacity of `this`.
+   *
+   * Relocates the elements with `memcpy` when they are trivially copyable; otherwise, they are
+   * moved (or copied, if `this` is a view). If an exception is thrown, `this` is left untouched.
+   *
+   * @param cap The requested capacity.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void reserve(size_t cap) {
+    if (cap <= cap_) return;
+    std::byte * brr = raw_allocate(cap);
+    try {
+      if (len_ == 0) {
+        // nothing to move
+      } else if (type_->trivial) std::memcpy(brr, arr_, len_ * type_->size);
+      else if (own_) type_->relocate(brr, arr_, len_);
+      else if (type_->copy) type_->copy(brr, arr_, len_);
+      else throw std::invalid_argument(std::format("Cannot copy a view of {}.", type_->name));
+    } catch (...) {
+      raw_deallocate(brr);
+      throw;
+    }
+    const size_t len = len_;
+    if (own_) {
+      len_ = 0;  // the elements were relocated
+      release();
+    }
+    arr_ = brr, len_ = len, cap_ = cap, own_ = true;
+  }
+
+  /**
+   * @brief Appends an element to `this`, doubling the capacity when `this` is full.
+   *
+   * @throws std::invalid_argument If the elements of `this` are not of type `T`.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<typename T>
+  requires (!std::same_as<std::remove_cvref_t<T>, AnySlice>)
+  void append(T && el) {
+    using U = std::remove_cvref_t<T>;
+    expect(SliceType::of<U>());
+    if (len_ == cap_) reserve(cap_ ? 2 * cap_ : 1);
+    new (at(len_)) U(std::forward<T>(el));
+    ++len_;
+  }
+
+  /**
+   * @brief Appends copies of the elements of `o` to `this`.
+   *
+   * @throws std::invalid_argument If the elements of `o` are not of the type of `this`, or not copyable.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(const AnySlice & o) {
+    expect(*o.type_);
+    if (o.len_ == 0) return;
+    if (!type_->trivial && !type_->copy) throw std::invalid_argument(std::format("Cannot copy {}.", type_->name));
+    if (len_ + o.len_ > cap_) reserve(std::max(len_ + o.len_, 2 * cap_));
+    if (type_->trivial) std::memcpy(at(len_), o.arr_, o.len_ * type_->size);
+    else type_->copy(at(len_), o.arr_, o.len_);
+    len_ += o.len_;
+  }
+
+  /**
+   * @brief Writes the elements of `this` to `os`, in binary form.
+   *
+   * @throws std::invalid_argument If the elements are not trivially copyable.
+   * @throws std::runtime_error If the stream cannot be written.
+   */
+  void save(std::ostream & os) const {
+    if (!type_->trivial) throw std::invalid_argument(std::format("Cannot serialize {}.", type_->name));
+    const uint64_t header[] = {MAGIC, VERSION, type_->size, type_->align, type_->name.size(), len_};
+    os.write(reinterpret_cast<const char *>(header), sizeof(header));
+    os.write(type_->name.data(), static_cast<std::streamsize>(type_->name.size()));
+    os.write(reinterpret_cast<const char *>(arr_), static_cast<std::streamsize>(len_ * type_->size));
+    if (!os) throw std::runtime_error("Failed to write AnySlice.");
+  }
+
+  /**
+   * @brief Reads the elements written by `save()`.
+   *
+   * @param is The stream to read from.
+   * @param type The expected type of the elements.
+   * @return The loaded slice.
+   *
+   * The elements are read a chunk at a time, growing `this` geometrically, so that the count
+   * in the header is only trusted as far as the stream actually holds elements.
+   *
+   * @throws std::runtime_error If the stream does not hold an `AnySlice` of type `type`.
+   */
+  static AnySlice load(std::istream & is, const SliceType & type) {
+    uint64_t header[6];
+    is.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!is || header[0] != MAGIC || header[1] != VERSION)
+      throw std::runtime_error("Stream does not hold an AnySlice.");
+    if (header[4] != type.name.size()) throw std::runtime_error(std::format("AnySlice does not hold {}.", type.name));
+    std::string name(header[4], '\0');
+    is.read(name.data(), static_cast<std::streamsize>(name.size()));
+    if (!type.trivial || header[2] != type.size || header[3] != type.align || name != type.name)
+      throw std::runtime_error(std::format("AnySlice holds {}, not {}.", name, type.name));
+    const uint64_t count = header[5];
+    if (count > SIZE_MAX / type.size) throw std::runtime_error("Corrupted AnySlice.");
+    AnySlice s(type, std::min<size_t>(count, std::max<size_t>(LOAD_CHUNK / type.size, 1)));
+    while (s.len_ < count) {
+      if (s.len_ == s.cap_) s.reserve(std::min<size_t>(count, 2 * s.cap_));
+      const size_t k = std::min<size_t>(count, s.cap_) - s.len_;
+      is.read(reinterpret_cast<char *>(s.at(s.len_)), static_cast<std::streamsize>(k * type.size));
+      if (!is) throw std::runtime_error("Truncated AnySlice.");
+      s.len_ += k;
+    }
+    return s;
+  }
+
+  /**
+   * @brief Converts `this` to a string representation, one element per line.
+   *
+   * @throws std::invalid_argument If the elements are not formattable.
+   */
+  std::string toString() const {
+    if (!type_->format) throw std::invalid_argument(std::format("Cannot format {}.", type_->name));
+    std::string s;
+    for (size_t i = 0; i < len_; ++i) type_->format(s, at(i));
+    return s;
+  }
+
+  /**
+   * @brief Destructor.
+   *
+   * Destroys the elements and frees the collection, unless `this` is a view.
+   */
+  ~AnySlice() noexcept { release(); }
+};
+
+#endif // ANY_SLICE_HXX
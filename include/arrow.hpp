@@ -0,0 +1,358 @@
+#ifndef ARROW_HXX
+#define ARROW_HXX
+
+#include <cppslice.hpp>
+#include <nullable_slice.hpp>
+#include <string_slice.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+ * The structures of the Apache Arrow C Data Interface, as specified (and guarded) by Arrow, so
+ * that they can be exchanged with any library that speaks it without depending on Arrow.
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+  const char * format;
+  const char * name;
+  const char * metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema ** children;
+  struct ArrowSchema * dictionary;
+  void (*release)(struct ArrowSchema *);
+  void * private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void ** buffers;
+  struct ArrowArray ** children;
+  struct ArrowArray * dictionary;
+  void (*release)(struct ArrowArray *);
+  void * private_data;
+};
+
+}
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/**
+ * @brief The element types with a fixed-width Arrow layout.
+ */
+template<typename T>
+concept ArrowPrimitive = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, long double>;
+
+/**
+ * @brief Returns the Arrow format string of `T`.
+ */
+template<ArrowPrimitive T>
+constexpr const char * arrow_format() noexcept {
+  if constexpr (std::is_same_v<T, float>) return "f";
+  else if constexpr (std::is_same_v<T, double>) return "g";
+  else if constexpr (sizeof(T) == 1) return std::is_signed_v<T> ? "c" : "C";
+  else if constexpr (sizeof(T) == 2) return std::is_signed_v<T> ? "s" : "S";
+  else if constexpr (sizeof(T) == 4) return std::is_signed_v<T> ? "i" : "I";
+  else return std::is_signed_v<T> ? "l" : "L";
+}
+
+/**
+ * @brief Returns the Arrow format string of the strings of a `BasicStringSlice<Offset>`.
+ */
+template<typename Offset>
+constexpr const char * arrow_string_format() noexcept {
+  return std::is_same_v<Offset, uint32_t> ? "u" : "U";
+}
+
+/**
+ * @class ArrowExport
+ * @brief Exports slices through the Arrow C Data Interface, without copying their elements.
+ *
+ * An exported `ArrowArray` owns what it exports: a moved `Slice` (or `StringSlice`), or a
+ * reference to a shared one, which its release callback frees or unreferences. Consumers may
+ * thus keep the buffers alive for as long as they need, independently of the exporter.
+ * Only `NullableSlice`s export nulls; other exports have a null count of 0 and no validity buffer.
+ */
+class ArrowExport {
+private:
+
+  /**
+   * @brief What an exported array keeps alive, and its buffer pointers.
+   */
+  template<typename Owned>
+  struct Holder {
+    Owned owned;              ///< The exported collection, or a reference to it.
+    const void * buffers[3];  ///< The buffers of the array.
+  };
+
+  template<typename Owned>
+  static void release(ArrowArray * a) noexcept {
+    delete static_cast<Holder<Owned> *>(a->private_data);
+    a->release = nullptr;
+  }
+
+  static void release(ArrowSchema * s) noexcept {
+    delete static_cast<std::string *>(s->private_data);
+    s->release = nullptr;
+  }
+
+  template<typename Owned>
+  static void fill(ArrowArray * out, std::unique_ptr<Holder<Owned>> h, int64_t length, int64_t n_buffers) noexcept {
+    *out = ArrowArray{length, 0, 0, n_buffers, 0, h->buffers, nullptr, nullptr, &release<Owned>, h.get()};
+    h.release();
+  }
+
+public:
+
+  /**
+   * @brief Exports a `Slice`, which the array takes over.
+   *
+   * @param s The exported slice, which must own its elements.
+   * @param out The array to initialize.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<ArrowPrimitive T>
+  static void array(Slice<T> && s, ArrowArray * out) {
+    const int64_t length = static_cast<int64_t>(s.size());
+    auto h = std::make_unique<Holder<Slice<T>>>(Holder<Slice<T>>{std::move(s), {}});
+    h->buffers[0] = nullptr, h->buffers[1] = h->owned.data();
+    fill(out, std::move(h), length, 2);
+  }
+
+  /**
+   * @brief Exports a shared `Slice`, which the array references until it is released.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<ArrowPrimitive T>
+  static void array(std::shared_ptr<const Slice<T>> s, ArrowArray * out) {
+    using Owned = std::shared_ptr<const Slice<T>>;
+    const int64_t length = static_cast<int64_t>(s->size());
+    auto h = std::make_unique<Holder<Owned>>(Holder<Owned>{std::move(s), {}});
+    h->buffers[0] = nullptr, h->buffers[1] = h->owned->data();
+    fill(out, std::move(h), length, 2);
+  }
+
+  /**
+   * @brief Exports a `NullableSlice`, which the array takes over.
+   *
+   * The validity bitmap of `s` is exported as is, or as `nullptr` when every value is valid.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<ArrowPrimitive T>
+  static void array(NullableSlice<T> && s, ArrowArray * out) {
+    static_assert(std::endian::native == std::endian::little, "Arrow bitmaps are little-endian.");
+    using Owned = NullableSlice<T>;
+    const int64_t length = static_cast<int64_t>(s.size()), nulls = static_cast<int64_t>(s.null_count());
+    auto h = std::make_unique<Holder<Owned>>(Holder<Owned>{std::move(s), {}});
+    h->buffers[0] = nulls ? h->owned.validity().data() : nullptr, h->buffers[1] = h->owned.values().data();
+    fill(out, std::move(h), length, 2);
+    out->null_count = nulls;
+  }
+
+  /**
+   * @brief Exports a `BasicStringSlice`, which the array takes over.
+   *
+   * @throws std::length_error If a 32-bit `StringSlice` holds more than 2^31 - 1 characters.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<typename Offset>
+  static void array(BasicStringSlice<Offset> && s, ArrowArray * out) {
+    if (std::is_same_v<Offset, uint32_t> && s.offsets().data()[s.size()] > INT32_MAX)
+      throw std::length_error("StringSlice too large for Arrow utf8.");
+    using Owned = BasicStringSlice<Offset>;
+    const int64_t length = static_cast<int64_t>(s.size());
+    auto h = std::make_unique<Holder<Owned>>(Holder<Owned>{std::move(s), {}});
+    static const char EMPTY = '\0';
+    h->buffers[0] = nullptr, h->buffers[1] = h->owned.offsets().data();
+    h->buffers[2] = h->owned.chars().data() ? h->owned.chars().data() : &EMPTY;
+    fill(out, std::move(h), length, 3);
+  }
+
+  /**
+   * @brief Exports the schema of a column with the given Arrow format.
+   *
+   * @param format The format string, e.g. `arrow_format<T>()`, which must be a static string.
+   * @param name The name of the column.
+   * @param out The schema to initialize.
+   * @param flags The Arrow flags of the column.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  static void schema(const char * format, const std::string & name, ArrowSchema * out, int64_t flags = 0) {
+    auto n = std::make_unique<std::string>(name);
+    *out = ArrowSchema{format, n->c_str(), nullptr, flags, 0, nullptr, nullptr, &release, n.get()};
+    n.release();
+  }
+};
+
+/**
+ * @class ArrowImport
+ * @brief Imports an array through the Arrow C Data Interface, as views over its buffers.
+ *
+ * An `ArrowImport` takes over an `ArrowArray` and its `ArrowSchema` (marking the originals as
+ * released, as the interface specifies for moves) and releases them when destroyed. The slices
+ * it returns view the buffers of the array without copying them, and must not outlive it.
+ */
+class ArrowImport {
+private:
+
+  ArrowArray array_;   ///< The imported array; released if `array_.release` is `nullptr`.
+  ArrowSchema schema_; ///< The schema of `array_`; released if `schema_.release` is `nullptr`.
+
+  /**
+   * @brief Checks that the array has the format `format`, `n` buffers and, unless `nullable`,
+   *        no null.
+   *
+   * @throws std::invalid_argument If it has not.
+   */
+  void expect(const char * format, int64_t n, bool nullable = false) const {
+    if (!array_.release || !schema_.release) throw std::invalid_argument("ArrowImport was released.");
+    if (std::strcmp(schema_.format, format) != 0)
+      throw std::invalid_argument(std::string("Arrow array has format ") + schema_.format + ", not " + format + ".");
+    if (array_.n_buffers != n) throw std::invalid_argument("Arrow array has an unexpected layout.");
+    if (!nullable && array_.null_count != 0 && array_.buffers[0] != nullptr)
+      throw std::invalid_argument("Arrow array has nulls.");
+  }
+
+  /**
+   * @brief Releases the array and its schema, if they are not released yet.
+   */
+  void release() noexcept {
+    if (array_.release) array_.release(&array_);
+    if (schema_.release) schema_.release(&schema_);
+  }
+
+  template<typename T>
+  const T * buffer(int64_t i) const {
+    const void * p = array_.buffers[i];
+    if (reinterpret_cast<uintptr_t>(p) % alignof(T)) throw std::invalid_argument("Arrow buffer is misaligned.");
+    return static_cast<const T *>(p);
+  }
+
+public:
+
+  /**
+   * @brief Takes over `array` and `schema`.
+   *
+   * @throws std::invalid_argument If either of them is already released.
+   */
+  ArrowImport(ArrowArray * array, ArrowSchema * schema) : array_(*array), schema_(*schema) {
+    if (!array->release || !schema->release) throw std::invalid_argument("Arrow array was released.");
+    array->release = nullptr, schema->release = nullptr;
+  }
+
+  ArrowImport(const ArrowImport &) = delete;
+  ArrowImport & operator=(const ArrowImport &) = delete;
+
+  ArrowImport(ArrowImport && o) noexcept : array_(o.array_), schema_(o.schema_) {
+    o.array_.release = nullptr, o.schema_.release = nullptr;
+  }
+
+  ArrowImport & operator=(ArrowImport && o) noexcept {
+    if (this != &o) {
+      release();
+      array_ = o.array_, schema_ = o.schema_;
+      o.array_.release = nullptr, o.schema_.release = nullptr;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Returns the number of elements of the array.
+   */
+  size_t size() const noexcept { return static_cast<size_t>(array_.length); }
+
+  /**
+   * @brief Returns the Arrow format string of the array.
+   */
+  const char * format() const noexcept { return schema_.format; }
+
+  /**
+   * @brief Returns the elements of a fixed-width array, as a view.
+   *
+   * @throws std::invalid_argument If the array does not hold `T`s without nulls.
+   */
+  template<ArrowPrimitive T>
+  Slice<T> values() const {
+    expect(arrow_format<T>(), 2);
+    if (array_.length == 0) return Slice<T>();
+    return Slice<T>(const_cast<T *>(buffer<T>(1)) + array_.offset, size());
+  }
+
+  /**
+   * @brief Returns the values of a fixed-width array that may hold nulls.
+   *
+   * The values are viewed; the validity bitmap, if any, is copied (one bit per value), since
+   * Arrow neither aligns nor pads it to whole words.
+   *
+   * @throws std::invalid_argument If the array does not hold `T`s.
+   */
+  template<ArrowPrimitive T>
+  NullableSlice<T> nullable() const {
+    expect(arrow_format<T>(), 2, true);
+    Slice<T> values = array_.length == 0 ? Slice<T>() : Slice<T>(const_cast<T *>(buffer<T>(1)) + array_.offset, size());
+    const auto * b = static_cast<const uint8_t *>(array_.buffers[0]);
+    if (array_.null_count == 0 || b == nullptr) return NullableSlice<T>(std::move(values));
+
+    const size_t n = size(), first = static_cast<size_t>(array_.offset);
+    Slice<uint64_t> bits((n + 63) / 64);
+    if (std::endian::native == std::endian::little && first % 8 == 0) {
+      for (size_t w = 0; w < (n + 63) / 64; ++w) {
+        uint64_t word = 0;
+        std::memcpy(&word, b + first / 8 + 8 * w, std::min<size_t>(8, (n - 64 * w + 7) / 8));
+        bits.append(word);
+      }
+    } else {
+      for (size_t w = 0; w < (n + 63) / 64; ++w) {
+        uint64_t word = 0;
+        for (size_t j = 0, i = first + 64 * w; j < 64 && 64 * w + j < n; ++j, ++i)
+          word |= uint64_t(b[i / 8] >> (i % 8) & 1) << j;
+        bits.append(word);
+      }
+    }
+    return NullableSlice<T>(std::move(values), std::move(bits));
+  }
+
+  /**
+   * @brief Returns the strings of a utf8 (`uint32_t` offsets) or large utf8 array, as a view.
+   *
+   * @throws std::invalid_argument If the array does not hold such strings without nulls.
+   */
+  template<typename Offset>
+  BasicStringSlice<Offset> strings() const {
+    expect(arrow_string_format<Offset>(), 3);
+    return BasicStringSlice<Offset>::view(buffer<char>(2), buffer<Offset>(1) + array_.offset, size());
+  }
+
+  /**
+   * @brief Destructor.
+   *
+   * Releases the array and its schema.
+   */
+  ~ArrowImport() noexcept { release(); }
+};
+
+#endif // ARROW_HXX
@@ -0,0 +1,430 @@
+#ifndef CORO_HXX
+#define CORO_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <semaphore>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Coroutine types for producing and consuming slices lazily: `Generator` (a synchronous
+ * `co_yield` sequence, until `std::generator` is available everywhere), `Task` (a lazy awaitable
+ * result), `AsyncGenerator` (a producer that `co_yield`s batches and may `co_await` in between)
+ * and the definition of `Slice::fill_async()`.
+ */
+
+/**
+ * @class Generator
+ * @brief A coroutine yielding a sequence of elements, consumed once as an input range.
+ *
+ * Each element is handed to the consumer as an rvalue, so that `Slice(gen())` or
+ * `slice.extend(gen())` moves it into place. As with `std::generator`, an rvalue is yielded by
+ * reference, and an lvalue is first copied into the promise, so that the producer's variables
+ * are never moved from.
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+class Generator {
+public:
+
+  struct promise_type {
+    T * value = nullptr;                  ///< The element yielded last.
+    std::optional<T> copy = std::nullopt; ///< The copy of the lvalue yielded last, if any.
+    std::exception_ptr error = nullptr;   ///< The exception the coroutine ended with, if any.
+
+    Generator get_return_object() noexcept { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    std::suspend_always yield_value(T && v) noexcept { return value = std::addressof(v), std::suspend_always(); }
+
+    std::suspend_always yield_value(const T & v) requires std::copy_constructible<T> {
+      copy.emplace(v);
+      return value = std::addressof(*copy), std::suspend_always();
+    }
+
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+    void await_transform() = delete;
+  };
+
+  using handle = std::coroutine_handle<promise_type>;
+
+  /**
+   * @brief The input iterator of a `Generator`.
+   */
+  class Iterator {
+  private:
+
+    handle h_; ///< The generator, resumed on increment.
+
+  public:
+
+    using value_type = T;
+    using reference = T &&;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() noexcept : h_(nullptr) {}
+
+    explicit Iterator(handle h) noexcept : h_(h) {}
+
+    T && operator*() const noexcept { return std::move(*h_.promise().value); }
+
+    Iterator & operator++() {
+      h_.resume();
+      if (h_.done() && h_.promise().error) std::rethrow_exception(std::exchange(h_.promise().error, nullptr));
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(std::default_sentinel_t) const noexcept { return !h_ || h_.done(); }
+  };
+
+private:
+
+  handle h_; ///< The coroutine, owned.
+
+  explicit Generator(handle h) noexcept : h_(h) {}
+
+public:
+
+  using value_type = T;
+
+  Generator(Generator && o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+
+  Generator & operator=(Generator && o) noexcept {
+    if (this != &o) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(o.h_, nullptr);
+    }
+    return *this;
+  }
+
+  Generator(const Generator &) = delete;
+  Generator & operator=(const Generator &) = delete;
+
+  ~Generator() {
+    if (h_) h_.destroy();
+  }
+
+  /**
+   * @brief Starts the generator, and returns an iterator to its first element.
+   *
+   * @throws Any exception the generator throws before yielding its first element.
+   */
+  Iterator begin() {
+    Iterator it(h_);
+    if (h_ && !h_.done()) ++it;
+    return it;
+  }
+
+  std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+/**
+ * @brief The part of the promise of a `Task` storing its result.
+ */
+template<typename T>
+struct TaskResult {
+  std::optional<T> value = std::nullopt; ///< The result, once returned.
+
+  void return_value(T v) { value.emplace(std::move(v)); }
+  T take() { return std::move(*value); }
+};
+
+template<>
+struct TaskResult<void> {
+  void return_void() noexcept {}
+  void take() noexcept {}
+};
+
+/**
+ * @class Task
+ * @brief A lazily started coroutine completing with a `T`, awaited once.
+ *
+ * A `Task` starts when it is awaited, and resumes its awaiter when it completes (by symmetric
+ * transfer, so that long chains of tasks do not grow the stack). `sync_wait()` runs it from
+ * ordinary code.
+ *
+ * @tparam T The type of the result.
+ */
+template<typename T = void>
+class Task {
+public:
+
+  struct promise_type : TaskResult<T> {
+    std::coroutine_handle<> continuation = std::noop_coroutine(); ///< The awaiter, resumed at the end.
+    std::exception_ptr error = nullptr;                           ///< The exception the task ended with.
+
+    /**
+     * @brief Resumes the awaiter of a completed task.
+     */
+    struct Final {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept { return h.promise().continuation; }
+      void await_resume() noexcept {}
+    };
+
+    Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    Final final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+  };
+
+  using handle = std::coroutine_handle<promise_type>;
+
+private:
+
+  handle h_; ///< The coroutine, owned.
+
+  explicit Task(handle h) noexcept : h_(h) {}
+
+public:
+
+  Task(Task && o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+
+  Task & operator=(Task && o) noexcept {
+    if (this != &o) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(o.h_, nullptr);
+    }
+    return *this;
+  }
+
+  Task(const Task &) = delete;
+  Task & operator=(const Task &) = delete;
+
+  ~Task() {
+    if (h_) h_.destroy();
+  }
+
+  bool await_ready() const noexcept { return !h_ || h_.done(); }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+    h_.promise().continuation = awaiter;
+    return h_;
+  }
+
+  /**
+   * @brief Returns the result of the task.
+   *
+   * @throws std::logic_error If the task is empty.
+   * @throws Any exception the task ended with.
+   */
+  T await_resume() {
+    if (!h_) throw std::logic_error("Awaiting an empty Task.");
+    if (h_.promise().error) std::rethrow_exception(h_.promise().error);
+    return h_.promise().take();
+  }
+};
+
+/**
+ * @brief A fire-and-forget coroutine, used to await a `Task` from ordinary code.
+ */
+struct SyncWaiter {
+  struct promise_type {
+    SyncWaiter get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+template<typename T>
+SyncWaiter sync_wait_run(Task<T> & t, std::optional<TaskResult<T>> & result, std::exception_ptr & error,
+                         std::binary_semaphore & done) {
+  try {
+    result.emplace();
+    if constexpr (std::is_void_v<T>) co_await t;
+    else result->return_value(co_await t);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  done.release();
+}
+
+/**
+ * @brief Runs `t` to completion, blocking the calling thread until it completes.
+ *
+ * @return The result of `t`.
+ *
+ * @throws Any exception `t` ended with.
+ */
+template<typename T>
+T sync_wait(Task<T> t) {
+  std::optional<TaskResult<T>> result;
+  std::exception_ptr error;
+  std::binary_semaphore done(0);
+  sync_wait_run(t, result, error, done);
+  done.acquire();
+  if (error) std::rethrow_exception(error);
+  return result->take();
+}
+
+/**
+ * @brief A source of elements read asynchronously, `read(dst, n)` at a time.
+ *
+ * `read(dst, n)` must return an awaiter that constructs up to `n` elements at `dst`, and resumes
+ * with their number, 0 once the source is exhausted. If it throws, it must first destroy the
+ * elements it constructed.
+ */
+template<typename Src, typename T>
+concept AsyncSource = requires(Src & s, T * dst, size_t n) {
+  { s.read(dst, n).await_resume() } -> std::convertible_to<size_t>;
+};
+
+/**
+ * @class AsyncGenerator
+ * @brief A coroutine producing batches of elements for an asynchronous consumer.
+ *
+ * The producer `co_yield`s batches (spans, or single elements) and may `co_await` anything in
+ * between, e.g. I/O. The consumer `co_await`s `read(dst, n)`, which copies the current batch
+ * straight into `dst` (e.g. the storage of a `Slice`, with `fill_async()`), and only resumes the
+ * producer once the batch is consumed. A batch must stay valid until the producer is resumed,
+ * which it does when it is held by the producer's own frame.
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+requires std::is_copy_constructible_v<T>
+class AsyncGenerator {
+public:
+
+  struct promise_type {
+    std::span<const T> batch{};                              ///< The batch yielded last.
+    size_t taken = 0;                                        ///< The elements of `batch` consumed.
+    std::coroutine_handle<> consumer = std::noop_coroutine(); ///< The reader, resumed on a yield.
+    std::exception_ptr error = nullptr;                      ///< The exception the producer ended with.
+
+    /**
+     * @brief Resumes the reader, unless the batch is empty.
+     */
+    struct Yield {
+      bool empty;
+
+      bool await_ready() const noexcept { return empty; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept { return h.promise().consumer; }
+      void await_resume() noexcept {}
+    };
+
+    AsyncGenerator get_return_object() noexcept {
+      return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    Yield final_suspend() noexcept { return Yield{false}; }
+    Yield yield_value(std::span<const T> b) noexcept { return batch = b, taken = 0, Yield{b.empty()}; }
+    Yield yield_value(const T & v) noexcept { return yield_value(std::span<const T>(std::addressof(v), 1)); }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+  };
+
+  using handle = std::coroutine_handle<promise_type>;
+
+  /**
+   * @brief The awaiter of `read()`.
+   */
+  class Read {
+  private:
+
+    handle h_;   ///< The producer.
+    T * dst_;    ///< Where to construct the elements.
+    size_t n_;   ///< The largest number of elements to construct.
+
+    size_t left() const noexcept { return h_.promise().batch.size() - h_.promise().taken; }
+
+  public:
+
+    Read(handle h, T * dst, size_t n) noexcept : h_(h), dst_(dst), n_(n) {}
+
+    bool await_ready() const noexcept { return !h_ || h_.done() || left() > 0; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+      h_.promise().consumer = consumer;
+      return h_;
+    }
+
+    /**
+     * @brief Copies up to `n` elements of the current batch to `dst`.
+     *
+     * @return The number of elements copied, 0 once the producer is done.
+     *
+     * @throws Any exception the producer ended with, or a copy threw.
+     */
+    size_t await_resume() {
+      if (!h_) return 0;
+      promise_type & p = h_.promise();
+      if (h_.done()) {
+        if (p.error) std::rethrow_exception(std::exchange(p.error, nullptr));
+        return 0;
+      }
+      const size_t k = std::min(n_, left());
+      std::uninitialized_copy_n(p.batch.data() + p.taken, k, dst_);
+      p.taken += k;
+      return k;
+    }
+  };
+
+private:
+
+  handle h_; ///< The coroutine, owned.
+
+  explicit AsyncGenerator(handle h) noexcept : h_(h) {}
+
+public:
+
+  AsyncGenerator(AsyncGenerator && o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+
+  AsyncGenerator & operator=(AsyncGenerator && o) noexcept {
+    if (this != &o) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(o.h_, nullptr);
+    }
+    return *this;
+  }
+
+  AsyncGenerator(const AsyncGenerator &) = delete;
+  AsyncGenerator & operator=(const AsyncGenerator &) = delete;
+
+  ~AsyncGenerator() {
+    if (h_) h_.destroy();
+  }
+
+  /**
+   * @brief Reads up to `n` elements into the uninitialized storage at `dst`.
+   */
+  Read read(T * dst, size_t n) noexcept { return Read(h_, dst, n); }
+};
+
+template<typename T>
+template<typename Src>
+Task<size_t> Slice<T>::fill_async(Src & source, size_t chunk) {
+  static_assert(AsyncSource<Src, T>, "fill_async needs an AsyncSource of the elements");
+  if (chunk == 0) throw std::invalid_argument("Chunks cannot be empty.");
+  size_t total = 0;
+  while (true) {
+    if (len_ + chunk > cap_) reserve(len_ + chunk > 2 * cap_ ? len_ + chunk : 2 * cap_);
+    const size_t got = co_await source.read(arr_ + len_, chunk);
+    if (got == 0) break;
+    len_ += got, total += got;
+  }
+  co_return total;
+}
+
+#endif // CORO_HXX
@@ -2,11 +2,78 @@
 #define SLICE_HXX
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <print>
+#include <ranges>
+#include <stream.hpp>
 #include <string>
 #include <type_traits>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+/**
+ * @brief The bytes from which `Slice::zeroed()` maps its storage straight from the kernel.
+ *
+ * Smaller zeroed slices are `calloc`ed, which may zero them eagerly.
+ */
+#ifndef SLICE_ZERO_MMAP_BYTES
+#define SLICE_ZERO_MMAP_BYTES (size_t(1) << 20)
+#endif
+
+/**
+ * @brief Debugging trace of the constructors and destructors of `Slice`.
+ *
+ * Traces are printed in debug builds only, so that release builds (and benchmarks) do not pay
+ * for them.
+ */
+#ifdef _DEBUG
+#define SLICE_TRACE(...) std::println(__VA_ARGS__)
+#else
+#define SLICE_TRACE(...) ((void) 0)
+#endif
+
+/**
+ * @brief Latency instrumentation of the operations of `Slice`.
+ *
+ * When `SLICE_LATENCY` is defined, the operations of `Slice` record their latency into the
+ * per-thread histograms of latency.hpp; otherwise the instrumentation compiles to nothing.
+ */
+#ifdef SLICE_LATENCY
+#include <latency.hpp>
+#define SLICE_TIMED(op) LatencyScope slice_latency_scope_(SliceOp::op)
+#else
+#define SLICE_TIMED(op) ((void) 0)
+#endif
+
+/**
+ * @brief Allocation tracing of `Slice`.
+ *
+ * When `SLICE_ALLOC_TRACE` is defined, the allocations, frees and growths of `Slice` are recorded
+ * into the per-thread logs of alloc_trace.hpp, to be flushed as a Chrome trace; otherwise the
+ * instrumentation compiles to nothing.
+ */
+#ifdef SLICE_ALLOC_TRACE
+#include <alloc_trace.hpp>
+#define SLICE_TRACE_ALLOC(kind, ptr, cap) AllocTracer::record(AllocKind::kind, ptr, (cap) * sizeof(T), typeid(T))
+#define SLICE_TRACE_GROW(from, to) AllocGrowScope slice_grow_scope_(typeid(T), (from) * sizeof(T), (to) * sizeof(T))
+#else
+#define SLICE_TRACE_ALLOC(kind, ptr, cap) ((void) 0)
+#define SLICE_TRACE_GROW(from, to) ((void) 0)
+#endif
+
+template<typename T>
+class Task;
+
 template<typename T, typename CollT>
 concept Iterable = requires(CollT c) {
   requires std::is_same_v<T, typename std::decay_t<CollT>::value_type>;
@@ -43,6 +110,12 @@ private:
   T * arr_;    ///< The collection of elements in `this`.
   size_t len_; ///< The number of elements currently in `this`.
   size_t cap_; ///< The maximum capacity of `this`.
+  bool own_;   ///< Whether `this` owns `arr_`, rather than viewing another collection.
+
+  /// Where an owned `arr_` was allocated, and so how it is freed.
+  enum class Storage : uint8_t {New, Calloc, Mapped};
+
+  Storage storage_ = Storage::New; ///< Where `arr_` was allocated.
 
   /*–
    * AF: a view over an array-like structure `arr_` with:
@@ -54,18 +127,87 @@ private:
    *      a_0, a_1, …, a_len-1 are the stored elements.
    *      a_len, …, a_cap are inactive elements that are over-allocated.
    *
+   *     If `own_` is false, `this` only views an array owned by someone else (e.g. the `Slice`
+   *     it was sliced from), and neither destroys its elements nor frees it. Otherwise, `arr_`
+   *     comes from `operator new`, `calloc` or `mmap`, as `storage_` tells.
+   *
    * ---
    *
    * RI: - 0 ≤ len_ < cap_
    *     - arr_ = nullptr ⇔ len_ = 0
    */
 
+  /// Whether `T` is aligned beyond what a plain `operator new` guarantees.
+  static constexpr bool OVERALIGNED = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  /**
+   * @brief Allocates an uninitialized chunk of data for `cap` elements.
+   *
+   * The chunk is aligned for `T`, even when `T` is over-aligned.
+   */
+  static T * raw_allocate(size_t cap) {
+    T * brr;
+    if constexpr (OVERALIGNED)
+      brr = static_cast<T *>(::operator new[](cap * sizeof(T), std::align_val_t(alignof(T))));
+    else brr = static_cast<T *>(::operator new[](cap * sizeof(T)));
+    SLICE_TRACE_ALLOC(Alloc, brr, cap);
+    return brr;
+  }
+
+  /**
+   * @brief Allocates a chunk of data for `cap` elements whose bytes are all zero.
+   *
+   * Large chunks are mapped anonymously (where `mmap` is available), so that the kernel zeroes
+   * each page on its first touch and untouched pages cost nothing; smaller ones are `calloc`ed.
+   *
+   * @param storage Set to where the chunk was allocated.
+   */
+  static T * raw_allocate_zeroed(size_t cap, Storage & storage) {
+    if (cap > SIZE_MAX / sizeof(T)) throw std::bad_array_new_length();
+    const size_t bytes = cap * sizeof(T);
+    void * p = nullptr;
+#if defined(__unix__) || defined(__APPLE__)
+    if (bytes >= SLICE_ZERO_MMAP_BYTES && alignof(T) <= 4096) {
+      p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED) throw std::bad_alloc();
+      storage = Storage::Mapped;
+    }
+#endif
+    if (!p) {
+      if constexpr (OVERALIGNED) {  // `calloc` only guarantees the default alignment
+        storage = Storage::New;
+        return static_cast<T *>(std::memset(raw_allocate(cap), 0, bytes));
+      }
+      if (!(p = std::calloc(cap, sizeof(T)))) throw std::bad_alloc();
+      storage = Storage::Calloc;
+    }
+    SLICE_TRACE_ALLOC(Alloc, static_cast<T *>(p), cap);
+    return static_cast<T *>(p);
+  }
+
+  /**
+   * @brief Frees a chunk of data of `cap` elements obtained from `raw_allocate()`, or from
+   *        `raw_allocate_zeroed()` with `storage`.
+   */
+  static void raw_deallocate(T * brr, [[maybe_unused]] size_t cap, Storage storage = Storage::New) noexcept {
+    SLICE_TRACE_ALLOC(Free, brr, cap);
+#if defined(__unix__) || defined(__APPLE__)
+    if (storage == Storage::Mapped) {
+      munmap(brr, cap * sizeof(T));
+      return;
+    }
+#endif
+    if (storage == Storage::Calloc) std::free(brr);
+    else if constexpr (OVERALIGNED) ::operator delete[](brr, std::align_val_t(alignof(T)));
+    else ::operator delete[](brr);
+  }
+
   /**
    * @brief Allocates memory for `this`.
    *
    * Allocates memory of the specified size and sets the view on that chunk of data.
    */
-  void allocate() { arr_ = static_cast<T *>(::operator new[](cap_ * sizeof(T))); }
+  void allocate() { arr_ = raw_allocate(cap_), own_ = true, storage_ = Storage::New; }
 
   /**
    * @brief Deallocates memory of `this`.
@@ -73,7 +215,8 @@ private:
    * Frees the memory and resets `this` to an empty state.
    */
   void deallocate() {
-    if (arr_) ::operator delete[](arr_), arr_ = nullptr, len_ = 0, cap_ = 0;
+    if (arr_ && own_) raw_deallocate(arr_, cap_, storage_);
+    arr_ = nullptr, len_ = 0, cap_ = 0, own_ = true, storage_ = Storage::New;
   }
 
   /**
@@ -85,13 +228,21 @@ private:
    * @param count The number of elements to destroy.
    */
   void destroy_elems(size_t count) {
-    if (!arr_) return;
+    if (!arr_ || !own_) return;
     if constexpr (!Destructible<T>) {
-      std::println("Non-trivial destruction");
+      SLICE_TRACE("Non-trivial destruction");
       for (size_t i = 0; i < count; ++i) arr_[i].~T();
     }
   }
 
+  /**
+   * @brief Returns the number of elements of `c`, or 0 if it can only be traversed once.
+   */
+  static size_t forward_size(auto && c) {
+    if constexpr (std::forward_iterator<decltype(std::begin(c))>) return std::distance(std::begin(c), std::end(c));
+    else return 0;
+  }
+
 public:
 
   /**
@@ -99,7 +250,7 @@ public:
    *
    * Creates an empty `this`.
    */
-  Slice() : arr_(nullptr), len_(0), cap_(0) {}
+  Slice() : arr_(nullptr), len_(0), cap_(0), own_(true) {}
 
   /**
    * @brief Size constructor.
@@ -108,7 +259,10 @@ public:
    *
    * @param cap The initial capacity of `this`.
    */
-  Slice(size_t cap) : arr_(nullptr), len_(0), cap_(cap) { allocate(); }
+  Slice(size_t cap) : arr_(nullptr), len_(0), cap_(cap), own_(true) {
+    SLICE_TIMED(Construct);
+    allocate();
+  }
 
   /**
    * @brief Array constructor.
@@ -121,7 +275,7 @@ public:
    *
    * @throws invalid_argument if the array pointer is `nullptr` and the size is greater than zero.
    */
-  Slice(T * brr, size_t size) : arr_(brr), len_(size), cap_(size) {
+  Slice(T * brr, size_t size) : arr_(brr), len_(size), cap_(size), own_(false) {
     if (brr == nullptr && size > 0) throw std::invalid_argument("Slice is nullptr with non zero size.");
   }
 
@@ -130,6 +284,8 @@ public:
    *
    * Creates `this` taking an existing collection of elements.
    * The collection can be either copied or moved.
+   * Single-pass collections (e.g. generators) are consumed once, growing `this` geometrically;
+   * the others are measured first, so that `this` is allocated exactly once.
    * If an exception is thrown, it triggers a cleanup routine and propagates the exception.
    *
    * @tparam CollT The type of the collection.
@@ -138,16 +294,27 @@ public:
    * @throws Any exception that may be thrown during the operation.
    */
   Slice(auto && c) requires Iterable<T, decltype(c)>
-      : arr_(nullptr), len_(std::distance(std::begin(c), std::end(c))), cap_(len_) {
+      : arr_(nullptr), len_(forward_size(c)), cap_(len_), own_(true) {
+    SLICE_TIMED(Construct);
+    if constexpr (!std::forward_iterator<decltype(std::begin(c))>) {
+      try {
+        extend(std::forward<decltype(c)>(c));
+      } catch (...) {
+        destroy_elems(len_);
+        deallocate();
+        throw;
+      }
+      return;
+    }
     allocate();
     size_t i = 0;
     try {
       for (auto && el : std::forward<decltype(c)>(c)) {
         if constexpr (std::move_constructible<T>) {
-          std::println("Iterable Move");
+          SLICE_TRACE("Iterable Move");
           new (arr_ + i) T(std::move(el));
         } else if constexpr (std::copy_constructible<T>) {
-          std::println("Iterable Copy");
+          SLICE_TRACE("Iterable Copy");
           new (arr_ + i) T(el);
         } else {
           static_assert(std::is_constructible_v<T, decltype(el)>,
@@ -174,15 +341,16 @@ public:
    * @throws Any exception that may be thrown during the operation.
    */
   Slice(auto &&... args) requires HomogeneousArgumented<T, decltype(args)...>
-      : arr_(nullptr), len_(sizeof...(args)), cap_(len_) {
+      : arr_(nullptr), len_(sizeof...(args)), cap_(len_), own_(true) {
+    SLICE_TIMED(Construct);
     allocate();
     size_t i = 0;
     try {
       if constexpr (std::move_constructible<T>) {
-        std::println("Variadic Move");
+        SLICE_TRACE("Variadic Move");
         ((new (arr_ + i++) T(std::move(args))), ...);
       } else if constexpr (std::copy_constructible<T>) {
-        std::println("Variadic Copy");
+        SLICE_TRACE("Variadic Copy");
         ((new (arr_ + i++) T(args)), ...);
       }
     } catch (...) {
@@ -192,6 +360,60 @@ public:
     }
   }
 
+  /**
+   * @brief Creates a `Slice` of `n` zero-valued elements, without writing them.
+   *
+   * The storage comes already zeroed (see `raw_allocate_zeroed()`): for large slices, construction
+   * takes constant time and each page only materializes when first touched, which suits slices
+   * that are mostly left untouched. Growing the slice later copies every element, and so touches
+   * every page. `T` must be a trivial type for which all-zero bytes are a valid value (e.g. an
+   * arithmetic type).
+   *
+   * @param n The number of elements.
+   * @return The new slice.
+   *
+   * @throws std::bad_alloc If the storage cannot be allocated.
+   */
+  static Slice zeroed(size_t n) requires std::is_trivially_default_constructible_v<T> && std::is_trivially_copyable_v<T> {
+    SLICE_TIMED(Construct);
+    Slice s;
+    if (n == 0) return s;
+    s.arr_ = raw_allocate_zeroed(n, s.storage_);
+    s.len_ = s.cap_ = n;
+    return s;
+  }
+
+  /**
+   * @brief Move constructor.
+   *
+   * Creates `this` stealing the collection of `o`, which is left empty.
+   *
+   * @param o The `Slice` to move from.
+   */
+  Slice(Slice && o) noexcept : arr_(o.arr_), len_(o.len_), cap_(o.cap_), own_(o.own_), storage_(o.storage_) {
+    o.arr_ = nullptr, o.len_ = 0, o.cap_ = 0, o.own_ = true, o.storage_ = Storage::New;
+  }
+
+  /**
+   * @brief Move assignment operator.
+   *
+   * Releases the collection of `this` and steals the one of `o`, which is left empty.
+   *
+   * @param o The `Slice` to move from.
+   * @return A reference to `this`.
+   */
+  Slice & operator=(Slice && o) noexcept {
+    if (this != &o) {
+      destroy_elems(len_), deallocate();
+      arr_ = o.arr_, len_ = o.len_, cap_ = o.cap_, own_ = o.own_, storage_ = o.storage_;
+      o.arr_ = nullptr, o.len_ = 0, o.cap_ = 0, o.own_ = true, o.storage_ = Storage::New;
+    }
+    return *this;
+  }
+
+  Slice(const Slice &) = delete;
+  Slice & operator=(const Slice &) = delete;
+
   /**
    * @brief Subscript operator.
    *
@@ -203,7 +425,7 @@ public:
    * @throws out_of_range if the index is out of bounds.
    */
   T * operator[](size_t i) {
-    if (i < 0 || i >= len_) throw std::out_of_range("Invalid argument");
+    if (i >= len_) throw std::out_of_range("Invalid argument");
     return &arr_[i];
   }
 
@@ -211,6 +433,7 @@ public:
    * @brief Slice operator.
    *
    * Provides a sub-slice from the specified start index to the end index.
+   * The sub-slice is a view sharing the elements of `this`, which must outlive it.
    *
    * @param i The start index of the sub-slice.
    * @param f The end index of the sub-slice.
@@ -219,16 +442,251 @@ public:
    * @throws out_of_range if the indices are out of bounds or invalid.
    */
   Slice<T> operator[](size_t i, size_t f) {
-    if (i < 0 || f < 0 || i >= len_ || f >= len_ || f <= i) throw std::out_of_range("Invalid argument");
+    SLICE_TIMED(SubSlice);
+    if (i >= len_ || f >= len_ || f <= i) throw std::out_of_range("Invalid argument");
     return Slice<T>(&arr_[i], f - i);
   }
 
+  /**
+   * @brief Returns the number of elements stored in `this`.
+   */
+  size_t size() const noexcept { return len_; }
+
+  /**
+   * @brief Returns the number of elements `this` can hold before reallocating.
+   */
+  size_t capacity() const noexcept { return cap_; }
+
+  /**
+   * @brief Returns a pointer to the first element of `this`, or `nullptr` if unallocated.
+   */
+  T * data() noexcept { return arr_; }
+  const T * data() const noexcept { return arr_; }
+
+  /**
+   * @brief Iterators over the stored elements of `this`.
+   */
+  T * begin() noexcept { return arr_; }
+  T * end() noexcept { return arr_ + len_; }
+  const T * begin() const noexcept { return arr_; }
+  const T * end() const noexcept { return arr_ + len_; }
+
+  /**
+   * @brief Relocates elements into uninitialized memory.
+   *
+   * Moves `count` elements from `src` to `dst` and ends the lifetime of the originals.
+   * Trivially copyable elements are relocated with a single `memcpy`; the others are moved if
+   * that cannot throw, copied otherwise, and then destroyed.
+   * If an exception is thrown, the elements already built in `dst` are destroyed, `src` is left
+   * untouched and the exception is propagated.
+   *
+   * @param dst The uninitialized memory to relocate to.
+   * @param src The elements to relocate.
+   * @param count The number of elements to relocate.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  static void relocate(T * dst, T * src, size_t count) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count) std::memcpy(static_cast<void *>(dst), static_cast<const void *>(src), count * sizeof(T));
+    } else {
+      size_t i = 0;
+      try {
+        for (; i < count; ++i) new (dst + i) T(std::move_if_noexcept(src[i]));
+      } catch (...) {
+        for (size_t j = 0; j < i; ++j) dst[j].~T();
+        throw;
+      }
+      for (i = 0; i < count; ++i) src[i].~T();
+    }
+  }
+
+  /**
+   * @brief Grows the capacity of `this`.
+   *
+   * Reallocates the collection so that it can hold at least `cap` elements, relocating the stored
+   * elements into the new chunk of data. If `this` is a view, the elements are copied instead (or
+   * moved, if they cannot be copied), and `this` stops viewing the original collection.
+   * If an exception is thrown, `this` is left untouched and the exception is propagated.
+   *
+   * @param cap The requested capacity.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void reserve(size_t cap) {
+    if (cap <= cap_) return;
+    SLICE_TIMED(Grow);
+    SLICE_TRACE_GROW(cap_, cap);
+    T * brr = raw_allocate(cap);
+    try {
+      if (own_) relocate(brr, arr_, len_);
+      else if constexpr (std::is_copy_constructible_v<T>) std::uninitialized_copy_n(arr_, len_, brr);
+      else std::uninitialized_move_n(arr_, len_, brr);
+    } catch (...) {
+      raw_deallocate(brr, cap);
+      throw;
+    }
+    size_t len = len_;
+    deallocate();
+    arr_ = brr, len_ = len, cap_ = cap, own_ = true;
+  }
+
+  /**
+   * @brief Appends an element to `this`.
+   *
+   * Constructs the element in place after the last stored one, doubling the capacity when `this`
+   * is full, like Go's `append`. The element must not alias an element of `this`.
+   *
+   * @param el The element to append.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(auto && el) requires std::constructible_from<T, decltype(el)> {
+    SLICE_TIMED(Append);
+    if (len_ == cap_) reserve(cap_ ? 2 * cap_ : 1);
+    new (arr_ + len_) T(std::forward<decltype(el)>(el));
+    ++len_;
+  }
+
+  /**
+   * @brief Appends copies of `n` elements to `this`.
+   *
+   * Grows the capacity at most once, to the larger of the needed size and twice the current
+   * capacity, so that repeated bulk appends take amortized constant time per element.
+   * Trivially copyable elements too large for the cache to keep (see `StreamStore::worth()`) are
+   * written with streaming stores, which leave the working set in the cache.
+   * The elements must not alias an element of `this`.
+   *
+   * @param src The first element to append.
+   * @param n The number of elements to append.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(const T * src, size_t n) requires std::is_copy_constructible_v<T> {
+    SLICE_TIMED(Append);
+    if (len_ + n > cap_) reserve(len_ + n > 2 * cap_ ? len_ + n : 2 * cap_);
+    if constexpr (std::is_trivially_copyable_v<T>)
+      if (StreamStore::worth(n * sizeof(T))) {
+        StreamStore::copy(arr_ + len_, src, n * sizeof(T));
+        len_ += n;
+        return;
+      }
+    std::uninitialized_copy_n(src, n, arr_ + len_);
+    len_ += n;
+  }
+
+  /**
+   * @brief Appends `n` elements constructed in place by `build`.
+   *
+   * Grows like the bulk `append()`, then lets `build(dst, n)` construct the elements directly in
+   * the uninitialized storage after the last stored one, e.g. from several threads at once.
+   * `build` must either construct all `n` elements, or destroy the ones it constructed and throw;
+   * `this` then keeps its previous elements and the exception is propagated.
+   *
+   * @param n The number of elements to append.
+   * @param build The callable constructing `n` elements at `dst`.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append_with(size_t n, auto && build) requires std::invocable<decltype(build), T *, size_t> {
+    SLICE_TIMED(Append);
+    if (len_ + n > cap_) reserve(len_ + n > 2 * cap_ ? len_ + n : 2 * cap_);
+    if (n == 0) return;
+    std::forward<decltype(build)>(build)(arr_ + len_, n);
+    len_ += n;
+  }
+
+  /**
+   * @brief Appends the elements of a range, in one pass.
+   *
+   * Ranges whose size is known in advance grow `this` at most once; the others (e.g. generators
+   * and other lazily produced sequences) grow it geometrically, like repeated appends.
+   * The elements must not alias an element of `this`.
+   *
+   * @param r The range of elements to append.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void extend(auto && r)
+      requires std::ranges::input_range<decltype(r)> && std::constructible_from<T, std::ranges::range_reference_t<decltype(r)>> {
+    if constexpr (std::ranges::sized_range<decltype(r)> || std::ranges::forward_range<decltype(r)>) {
+      const size_t n = static_cast<size_t>(std::ranges::distance(r));
+      if (len_ + n > cap_) reserve(len_ + n > 2 * cap_ ? len_ + n : 2 * cap_);
+    }
+    for (auto && el : r) append(std::forward<decltype(el)>(el));
+  }
+
+  /**
+   * @brief Appends the elements read from an asynchronous source, up to `chunk` at a time.
+   *
+   * Each read constructs its elements directly in the storage of `this`, which grows
+   * geometrically. `this` must stay in place until the returned task completes. Defined in
+   * coro.hpp, which must be included to use it.
+   *
+   * @param source The source, whose `read(dst, n)` is an awaitable constructing up to `n`
+   *               elements at `dst` and returning their number, 0 once exhausted.
+   * @param chunk The largest number of elements to read at a time.
+   * @return A task completing with the number of elements appended.
+   */
+  template<typename Src>
+  Task<size_t> fill_async(Src & source, size_t chunk = 4096);
+
+  /**
+   * @brief Constructs a `Slice` holding a copy of each element of a random-access range, from
+   *        several threads.
+   *
+   * The destination is cut into partitions, each constructed by one task on `exec` (a
+   * `ThreadPool` or a scheduler). If any construction fails, the partitions already constructed
+   * are destroyed and the first exception is propagated. Defined in execution.hpp, which must be
+   * included to use it.
+   *
+   * @param r The range to copy.
+   * @param exec Where to run the partitions.
+   * @return The new slice.
+   */
+  template<typename R, typename E>
+  static Slice from_parallel(R && r, E && exec);
+
+  /**
+   * @brief Appends `n` copies of `value`, constructed from several threads.
+   *
+   * Like `from_parallel()`, `this` is left unchanged if a copy fails. Like the bulk `append()`,
+   * large fills of trivially copyable elements use streaming stores. Defined in execution.hpp.
+   */
+  template<typename E>
+  void parallel_fill(size_t n, const T & value, E && exec);
+
+  /**
+   * @brief Appends copies of `n` elements starting at `src`, constructed from several threads.
+   *
+   * Like `from_parallel()`, `this` is left unchanged if a copy fails, and like the bulk
+   * `append()`, large copies of trivially copyable elements use streaming stores. `src` must not
+   * alias an element of `this`. Defined in execution.hpp.
+   */
+  template<typename E>
+  void parallel_copy(const T * src, size_t n, E && exec);
+
+  /**
+   * @brief Shrinks `this` to its first `n` elements, like Go's `s = s[:n]`.
+   *
+   * Destroys the other elements (unless `this` is a view) and keeps the capacity.
+   * Does nothing if `n` is not lower than the number of elements.
+   *
+   * @param n The number of elements to keep.
+   */
+  void truncate(size_t n) noexcept {
+    if (n >= len_) return;
+    if constexpr (!Destructible<T>)
+      if (own_) for (size_t i = len_; i > n; --i) arr_[i - 1].~T();
+    len_ = n;
+  }
+
   /**
    * @brief Converts `this` to a string representation.
    *
    * @return A string representation of `this`.
    */
-  std::string toString() { // XXX: arr_[i] must support formatting
+  std::string toString() requires std::formattable<T, char> {
     std::string s;
     for (size_t i = 0; i < len_; ++i) s += std::format("{}\n", arr_[i]);
     return s;
@@ -237,7 +695,7 @@ public:
   /**
    * @brief Prints the string representation of `this`.
    */
-  void print() { std::println("{}", toString()); }
+  void print() requires std::formattable<T, char> { std::println("{}", toString()); }
 
   /**
    * @brief Destructor.
@@ -245,7 +703,28 @@ public:
    * If the elements can be trivially destroyed, it simply deletes the collection and puts `this`
    * in a waiting phase. Otherwise, it calls the destructor for those particular elements.
    */
-  ~Slice() noexcept { destroy_elems(len_), deallocate(); }
+  ~Slice() noexcept {
+    SLICE_TIMED(Destroy);
+    destroy_elems(len_), deallocate();
+  }
 };
 
+/**
+ * @brief Explicit instantiation declarations for the common element types.
+ *
+ * When `SLICE_EXTERN_TEMPLATES` is defined, translation units do not instantiate the non-template
+ * members of `Slice` for these types, and link against the instantiations compiled once into the
+ * library (`make lib`) instead. Member templates (the iterable and variadic constructors,
+ * `append(auto &&)`, `append_with()`, `extend()`, …) are not covered by an explicit instantiation,
+ * and are still instantiated by every translation unit that uses them. The library must be built
+ * with the same instrumentation macros as its users.
+ */
+#ifdef SLICE_EXTERN_TEMPLATES
+extern template class Slice<int>;
+extern template class Slice<float>;
+extern template class Slice<double>;
+extern template class Slice<std::byte>;
+extern template class Slice<char>;
+#endif
+
 #endif // SLICE_HXX
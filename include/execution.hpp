@@ -0,0 +1,794 @@
+#ifndef EXECUTION_HXX
+#define EXECUTION_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <semaphore>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+ * A small sender/receiver layer in the style of P2300 (std::execution), for composing work over
+ * slices without blocking threads or writing callbacks by hand.
+ *
+ * A sender describes work that completes with a single value (`value_type`, possibly `void`) or
+ * an exception. `connect()`ing it to a receiver yields an operation state, which must stay in
+ * place until it completes; `start()` launches it, and it eventually calls `set_value()` or
+ * `set_error()` on the receiver, on whatever thread finished the work. Senders are composed with
+ * `then`, `bulk` and `when_all`, either as calls or with `|`, and started on a scheduler with
+ * `schedule()`. `sync_wait()` is the only operation that blocks.
+ *
+ * A scheduler is anything that can `enqueue()` a `WorkItem`, e.g. `InlineScheduler`, the
+ * scheduler of a `ThreadPool`, or an event loop driving io_uring. Cancellation (`set_stopped`)
+ * and the environment queries of P2300 are left out, except for the scheduler a sender completes
+ * on, which `bulk` uses to spread its iterations.
+ *
+ * It also defines `Slice::from_parallel()`, `Slice::parallel_fill()` and `Slice::parallel_copy()`,
+ * which construct large slices from several threads.
+ */
+
+/**
+ * @brief A unit of work queued on a scheduler, intrusively linked and owned by its enqueuer.
+ */
+struct WorkItem {
+  WorkItem * next = nullptr;             ///< The next item in the queue.
+  void (*run)(WorkItem *) = nullptr; ///< Runs the work; may destroy the item.
+};
+
+template<typename S>
+concept Scheduler = std::copy_constructible<S> && requires(S & s, WorkItem * w) {
+  s.enqueue(w);
+  { s.concurrency() } -> std::convertible_to<size_t>;
+};
+
+template<typename S>
+concept Sender = std::move_constructible<std::remove_cvref_t<S>> && requires {
+  typename std::remove_cvref_t<S>::value_type;
+  typename std::remove_cvref_t<S>::sender_tag;
+};
+
+/**
+ * @brief Holds the value of a sender, `std::monostate` for `void`.
+ */
+template<typename V>
+using SenderSlot = std::conditional_t<std::is_void_v<V>, std::monostate, V>;
+
+template<typename V, typename F, typename... Args>
+using then_result_t = std::conditional_t<std::is_void_v<V>, std::invoke_result<F, Args...>,
+                                         std::invoke_result<F, Args..., V>>;
+
+/**
+ * @brief Completes `r` with the value in `slot`.
+ */
+template<typename V, typename R>
+void deliver(R & r, SenderSlot<V> && slot) {
+  if constexpr (std::is_void_v<V>) r.set_value();
+  else r.set_value(std::move(slot));
+}
+
+/**
+ * @brief Calls `f(args..., value)`, or `f(args...)` for `void`.
+ */
+template<typename V>
+decltype(auto) invoke_with(auto && f, SenderSlot<V> & slot, auto &&... args) {
+  if constexpr (std::is_void_v<V>) return std::invoke(f, std::forward<decltype(args)>(args)...);
+  else return std::invoke(f, std::forward<decltype(args)>(args)..., slot);
+}
+
+/**
+ * @brief Returns the scheduler `s` completes on, or `std::monostate` if it is not known.
+ */
+template<typename S>
+auto completion_scheduler_of(const S & s) {
+  if constexpr (requires { s.completion_scheduler(); }) return s.completion_scheduler();
+  else return std::monostate();
+}
+
+/**
+ * @class InlineScheduler
+ * @brief A scheduler running work immediately, on the thread that enqueues it.
+ */
+class InlineScheduler {
+public:
+
+  void enqueue(WorkItem * w) const { w->run(w); }
+
+  size_t concurrency() const noexcept { return 1; }
+
+  bool operator==(const InlineScheduler &) const noexcept = default;
+};
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads running the work enqueued on its scheduler, in order.
+ *
+ * Work items are linked into a FIFO queue without allocating. The destructor runs the work
+ * already queued, then joins the workers.
+ */
+class ThreadPool {
+private:
+
+  std::mutex mutex_{};              ///< Guards the queue and `stop_`.
+  std::condition_variable ready_{}; ///< Signalled when work is queued, or on stop.
+  WorkItem * head_ = nullptr;       ///< The oldest queued item.
+  WorkItem * tail_ = nullptr;       ///< The newest queued item.
+  bool stop_ = false;               ///< Whether the workers should exit once the queue is empty.
+  std::vector<std::jthread> threads_{};
+
+  void loop() {
+    while (true) {
+      WorkItem * w;
+      {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return head_ || stop_; });
+        if (!head_) return;
+        w = head_;
+        head_ = w->next;
+        if (!head_) tail_ = nullptr;
+      }
+      w->run(w);
+    }
+  }
+
+  void stop() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    ready_.notify_all();
+    threads_.clear();
+  }
+
+public:
+
+  /**
+   * @brief The scheduler of a `ThreadPool`, a handle that must not outlive it.
+   */
+  class Scheduler {
+  private:
+
+    ThreadPool * pool_; ///< The pool.
+
+  public:
+
+    explicit Scheduler(ThreadPool * pool) noexcept : pool_(pool) {}
+
+    void enqueue(WorkItem * w) const { pool_->enqueue(w); }
+
+    size_t concurrency() const noexcept { return pool_->size(); }
+
+    bool operator==(const Scheduler &) const noexcept = default;
+  };
+
+  /**
+   * @brief Creates a pool of `n` workers, or one per hardware thread if `n` is 0.
+   *
+   * @throws std::system_error If a thread cannot be started.
+   */
+  explicit ThreadPool(size_t n = 0) {
+    if (n == 0) n = std::max<size_t>(1, std::thread::hardware_concurrency());
+    try {
+      threads_.reserve(n);
+      for (size_t i = 0; i < n; ++i) threads_.emplace_back([this] { loop(); });
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() { stop(); }
+
+  /**
+   * @brief Returns the number of workers.
+   */
+  size_t size() const noexcept { return threads_.size(); }
+
+  Scheduler scheduler() noexcept { return Scheduler(this); }
+
+  /**
+   * @brief Queues `w`, to be run by the first idle worker.
+   */
+  void enqueue(WorkItem * w) {
+    w->next = nullptr;
+    {
+      std::lock_guard lock(mutex_);
+      (tail_ ? tail_->next : head_) = w;
+      tail_ = w;
+    }
+    ready_.notify_one();
+  }
+};
+
+/**
+ * @brief A sender completing without a value on `S`.
+ */
+template<Scheduler S>
+class ScheduleSender {
+private:
+
+  S sched_; ///< The scheduler.
+
+public:
+
+  using sender_tag = void;
+  using value_type = void;
+
+  template<typename R>
+  struct Op : WorkItem {
+    S sched; ///< The scheduler.
+    R r;     ///< The receiver.
+
+    Op(S s, R rcv) : WorkItem{nullptr, [](WorkItem * w) { static_cast<Op *>(w)->r.set_value(); }}, sched(s), r(std::move(rcv)) {}
+    Op(const Op &) = delete;
+    Op & operator=(const Op &) = delete;
+
+    void start() noexcept {
+      try {
+        sched.enqueue(this);
+      } catch (...) {
+        r.set_error(std::current_exception());
+      }
+    }
+  };
+
+  explicit ScheduleSender(S s) : sched_(s) {}
+
+  S completion_scheduler() const { return sched_; }
+
+  template<typename R>
+  Op<R> connect(R r) && { return Op<R>(sched_, std::move(r)); }
+};
+
+/**
+ * @brief Returns a sender completing on `s`, to start a chain of work there.
+ */
+template<Scheduler S>
+ScheduleSender<S> schedule(S s) { return ScheduleSender<S>(s); }
+
+/**
+ * @brief A closure of an adaptor, applied to a sender with `|`.
+ */
+template<typename F>
+struct SenderAdaptor {
+  F make; ///< Returns the adapted sender.
+
+  template<Sender S>
+  friend auto operator|(S && s, SenderAdaptor a) { return a.make(std::forward<S>(s)); }
+};
+
+/**
+ * @brief The sender of `then(s, f)`.
+ */
+template<Sender S, typename F>
+class ThenSender {
+private:
+
+  using In = typename S::value_type;
+
+  S s_; ///< The predecessor.
+  F f_; ///< The continuation.
+
+  template<typename R>
+  struct Receiver {
+    R r; ///< The downstream receiver.
+    F f; ///< The continuation.
+
+    template<typename... V>
+    void set_value(V &&... v) {
+      try {
+        if constexpr (std::is_void_v<value_type>) {
+          std::invoke(f, std::forward<V>(v)...);
+          r.set_value();
+        } else r.set_value(std::invoke(f, std::forward<V>(v)...));
+      } catch (...) {
+        r.set_error(std::current_exception());
+      }
+    }
+
+    void set_error(std::exception_ptr e) { r.set_error(std::move(e)); }
+  };
+
+public:
+
+  using sender_tag = void;
+  using value_type = std::decay_t<typename then_result_t<In, F &>::type>;
+
+  ThenSender(S s, F f) : s_(std::move(s)), f_(std::move(f)) {}
+
+  auto completion_scheduler() const requires requires(const S & s) { s.completion_scheduler(); } { return s_.completion_scheduler(); }
+
+  template<typename R>
+  auto connect(R r) && { return std::move(s_).connect(Receiver<R>{std::move(r), std::move(f_)}); }
+};
+
+/**
+ * @brief Returns a sender completing with `f(v)`, where `v` is the value of `s` (if any).
+ *
+ * An exception thrown by `f` completes the sender with that exception.
+ */
+template<Sender S, typename F>
+ThenSender<std::remove_cvref_t<S>, F> then(S && s, F f) { return {std::forward<S>(s), std::move(f)}; }
+
+template<typename F>
+auto then(F f) {
+  return SenderAdaptor{[f = std::move(f)]<Sender S>(S && s) mutable { return then(std::forward<S>(s), std::move(f)); }};
+}
+
+/**
+ * @brief The sender of `bulk(s, n, f)`.
+ */
+template<Sender S, typename F>
+class BulkSender {
+private:
+
+  using V = typename S::value_type;
+
+  S s_;     ///< The predecessor.
+  size_t n_; ///< The number of iterations.
+  F f_;     ///< The iteration.
+
+  template<typename R>
+  class Op {
+  private:
+
+    using Sched = decltype(completion_scheduler_of(std::declval<const S &>()));
+
+    /**
+     * @brief The receiver of the predecessor, spreading the iterations.
+     */
+    struct Receiver {
+      Op * op; ///< The operation.
+
+      template<typename... X>
+      void set_value(X &&... x) {
+        op->value_.emplace(std::forward<X>(x)...);
+        op->dispatch();
+      }
+
+      void set_error(std::exception_ptr e) { op->r_.set_error(std::move(e)); }
+    };
+
+    /**
+     * @brief A share of the iterations, run as one work item.
+     */
+    struct Part : WorkItem {
+      Op * op = nullptr;      ///< The operation.
+      size_t lo = 0, hi = 0; ///< The iterations of the share.
+    };
+
+    Sched sched_;                                                   ///< Where the shares run.
+    size_t n_;                                                      ///< The number of iterations.
+    F f_;                                                           ///< The iteration.
+    R r_;                                                           ///< The downstream receiver.
+    std::optional<SenderSlot<V>> value_{};                          ///< The value of the predecessor.
+    std::vector<Part> parts_{};                                     ///< The shares.
+    std::atomic<size_t> pending_{0};                                ///< The shares not done yet.
+    std::exception_ptr error_{};                                    ///< The first exception thrown.
+    std::mutex mutex_{};                                            ///< Guards `error_`.
+    decltype(std::move(std::declval<S>()).connect(std::declval<Receiver>())) inner_; ///< The predecessor.
+
+    void run(size_t lo, size_t hi) noexcept {
+      try {
+        for (size_t i = lo; i < hi; ++i) invoke_with<V>(f_, *value_, i);
+      } catch (...) {
+        std::lock_guard lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+      }
+    }
+
+    void finish() {
+      if (error_) r_.set_error(error_);
+      else deliver<V>(r_, std::move(*value_));
+    }
+
+    void dispatch() {
+      size_t shares = 1;
+      if constexpr (!std::is_same_v<Sched, std::monostate>) shares = std::min(n_, 4 * sched_.concurrency());
+      if (shares <= 1) {
+        run(0, n_);
+        return finish();
+      }
+      try {
+        parts_.resize(shares);
+      } catch (...) {
+        return r_.set_error(std::current_exception());
+      }
+      pending_.store(shares, std::memory_order_relaxed);
+      for (size_t k = 0; k < shares; ++k) {
+        Part & p = parts_[k];
+        p.op = this, p.lo = n_ * k / shares, p.hi = n_ * (k + 1) / shares;
+        p.run = [](WorkItem * w) {
+          Part * part = static_cast<Part *>(w);
+          Op * op = part->op;
+          op->run(part->lo, part->hi);
+          if (op->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) op->finish();
+        };
+      }
+      if constexpr (!std::is_same_v<Sched, std::monostate>)
+        for (size_t k = 0; k < shares; ++k) {
+          try {
+            sched_.enqueue(&parts_[k]);
+          } catch (...) {
+            parts_[k].run(&parts_[k]);  // run the share here if it cannot be queued
+          }
+        }
+    }
+
+  public:
+
+    Op(S && s, size_t n, F f, R r)
+        : sched_(completion_scheduler_of(s)), n_(n), f_(std::move(f)), r_(std::move(r)),
+          inner_(std::move(s).connect(Receiver{this})) {}
+
+    Op(const Op &) = delete;
+    Op & operator=(const Op &) = delete;
+
+    void start() noexcept { inner_.start(); }
+  };
+
+public:
+
+  using sender_tag = void;
+  using value_type = V;
+
+  BulkSender(S s, size_t n, F f) : s_(std::move(s)), n_(n), f_(std::move(f)) {}
+
+  auto completion_scheduler() const requires requires(const S & s) { s.completion_scheduler(); } { return s_.completion_scheduler(); }
+
+  template<typename R>
+  Op<R> connect(R r) && { return Op<R>(std::move(s_), n_, std::move(f_), std::move(r)); }
+};
+
+/**
+ * @brief Returns a sender calling `f(i, v)` for `0 ≤ i < n`, where `v` is the value of `s` (if
+ *        any), then completing with `v`.
+ *
+ * The iterations are split into a few shares per worker of the scheduler `s` completes on, and
+ * run concurrently there; they run inline if that scheduler is not known. If iterations throw,
+ * the sender completes with the first exception, once every share is done.
+ */
+template<Sender S, typename F>
+BulkSender<std::remove_cvref_t<S>, F> bulk(S && s, size_t n, F f) { return {std::forward<S>(s), n, std::move(f)}; }
+
+template<typename F>
+auto bulk(size_t n, F f) {
+  return SenderAdaptor{[n, f = std::move(f)]<Sender S>(S && s) mutable { return bulk(std::forward<S>(s), n, std::move(f)); }};
+}
+
+/**
+ * @brief The sender of `when_all(s...)`.
+ */
+template<Sender... Ss>
+class WhenAllSender {
+private:
+
+  std::tuple<Ss...> ss_; ///< The senders.
+
+public:
+
+  using sender_tag = void;
+  using value_type = std::tuple<SenderSlot<typename Ss::value_type>...>;
+
+private:
+
+  template<typename R>
+  class Op {
+  private:
+
+    template<size_t I>
+    struct Receiver {
+      Op * op; ///< The operation.
+
+      template<typename... X>
+      void set_value(X &&... x) {
+        if constexpr (sizeof...(X) > 0) std::get<I>(op->values_).emplace(std::forward<X>(x)...);
+        else std::get<I>(op->values_).emplace();
+        op->arrive();
+      }
+
+      void set_error(std::exception_ptr e) {
+        {
+          std::lock_guard lock(op->mutex_);
+          if (!op->error_) op->error_ = std::move(e);
+        }
+        op->arrive();
+      }
+    };
+
+    /**
+     * @brief The operations of the senders from the `I`-th, each constructed in place.
+     */
+    template<size_t I, typename... Rest>
+    struct Ops {
+      explicit Ops(Op *) {}
+      void start() noexcept {}
+    };
+
+    template<size_t I, typename First, typename... Rest>
+    struct Ops<I, First, Rest...> {
+      decltype(std::declval<First>().connect(std::declval<Receiver<I>>())) op; ///< The `I`-th operation.
+      Ops<I + 1, Rest...> rest;                                                  ///< The following ones.
+
+      Ops(Op * parent, First && s, Rest &&... r)
+          : op(std::move(s).connect(Receiver<I>{parent})), rest(parent, std::move(r)...) {}
+
+      void start() noexcept { op.start(), rest.start(); }
+    };
+
+    R r_;                                                         ///< The downstream receiver.
+    std::tuple<std::optional<SenderSlot<typename Ss::value_type>>...> values_{}; ///< The values so far.
+    std::atomic<size_t> pending_{sizeof...(Ss)};                  ///< The senders not done yet.
+    std::exception_ptr error_{};                                  ///< The first exception.
+    std::mutex mutex_{};                                          ///< Guards `error_`.
+    Ops<0, Ss...> ops_;                                           ///< The operations.
+
+    void arrive() {
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+      if (error_) return r_.set_error(error_);
+      std::optional<value_type> all;
+      try {
+        all.emplace(std::apply([](auto &... v) { return value_type(std::move(*v)...); }, values_));
+      } catch (...) {
+        return r_.set_error(std::current_exception());
+      }
+      r_.set_value(std::move(*all));
+    }
+
+  public:
+
+    Op(std::tuple<Ss...> && ss, R r)
+        : r_(std::move(r)), ops_(std::apply([this](auto &&... s) { return Ops<0, Ss...>(this, std::move(s)...); }, ss)) {}
+
+    Op(const Op &) = delete;
+    Op & operator=(const Op &) = delete;
+
+    void start() noexcept {
+      if constexpr (sizeof...(Ss) == 0) r_.set_value(value_type());
+      else ops_.start();
+    }
+  };
+
+public:
+
+  explicit WhenAllSender(Ss... ss) : ss_(std::move(ss)...) {}
+
+  template<typename R>
+  Op<R> connect(R r) && { return Op<R>(std::move(ss_), std::move(r)); }
+};
+
+/**
+ * @brief Returns a sender completing with the tuple of the values of `ss` once they all complete.
+ *
+ * The senders are started together, and `void` values are `std::monostate`s. If any of them
+ * fails, the sender completes with the first exception, once every one is done.
+ */
+template<Sender... Ss>
+WhenAllSender<std::remove_cvref_t<Ss>...> when_all(Ss &&... ss) { return WhenAllSender<std::remove_cvref_t<Ss>...>(std::forward<Ss>(ss)...); }
+
+/**
+ * @brief The state of a `sync_wait()` over a sender of `V`.
+ */
+template<typename V>
+struct SyncWaitState {
+  std::optional<SenderSlot<V>> value{}; ///< The value, once completed.
+  std::exception_ptr error{};           ///< The exception, if it failed.
+  std::binary_semaphore done{0};        ///< Released on completion.
+};
+
+template<typename V>
+struct SyncWaitReceiver {
+  SyncWaitState<V> * st; ///< The state of the wait.
+
+  template<typename... X>
+  void set_value(X &&... x) {
+    try {
+      st->value.emplace(std::forward<X>(x)...);
+    } catch (...) {
+      st->error = std::current_exception();
+    }
+    st->done.release();
+  }
+
+  void set_error(std::exception_ptr e) {
+    st->error = std::move(e);
+    st->done.release();
+  }
+};
+
+/**
+ * @brief Starts `s` and blocks the calling thread until it completes.
+ *
+ * @return The value of `s`.
+ *
+ * @throws Any exception `s` completed with.
+ */
+template<Sender S>
+auto sync_wait(S && s) {
+  using V = typename std::remove_cvref_t<S>::value_type;
+  SyncWaitState<V> state;
+  auto op = std::remove_cvref_t<S>(std::forward<S>(s)).connect(SyncWaitReceiver<V>{&state});
+  op.start();
+  state.done.acquire();
+  if (state.error) std::rethrow_exception(state.error);
+  if constexpr (!std::is_void_v<V>) return std::move(*state.value);
+}
+
+/**
+ * @brief Returns a sender replacing each element `x` of `s` with `f(x)`, in parallel on `sched`.
+ *
+ * `s` must stay alive and untouched until the sender completes.
+ */
+template<Scheduler Sch, typename T, typename F>
+requires std::is_assignable_v<T &, std::invoke_result_t<F &, T &>>
+auto bulk_transform(Sch sched, Slice<T> & s, F f) {
+  T * a = s.data();
+  return schedule(sched) | bulk(s.size(), [a, f = std::move(f)](size_t i) mutable { a[i] = f(a[i]); });
+}
+
+/**
+ * @brief Returns a sender completing with `init` combined with every element of `s` through `op`,
+ *        in parallel on `sched`.
+ *
+ * `op` must be associative, as the elements are combined in contiguous runs first, and the
+ * partial results of the runs then combined in order, also through `op`.
+ */
+template<Scheduler Sch, typename T, typename U, typename Op>
+requires std::is_copy_constructible_v<U> && std::constructible_from<U, const T &>
+         && std::convertible_to<std::invoke_result_t<Op &, U, const T &>, U>
+         && std::convertible_to<std::invoke_result_t<Op &, U, U>, U>
+auto bulk_reduce(Sch sched, const Slice<T> & s, U init, Op op) {
+  const T * a = s.data();
+  const size_t n = s.size(), runs = std::max<size_t>(1, std::min(n, 4 * sched.concurrency()));
+  return schedule(sched)
+    | then([runs] { return std::vector<std::optional<U>>(runs); })
+    | bulk(runs, [a, n, runs, op](size_t r, std::vector<std::optional<U>> & partial) {
+        const size_t lo = n * r / runs, hi = n * (r + 1) / runs;
+        if (lo == hi) return;
+        U acc = U(a[lo]);
+        for (size_t i = lo + 1; i < hi; ++i) acc = op(std::move(acc), a[i]);
+        partial[r].emplace(std::move(acc));
+      })
+    | then([init = std::move(init), op](std::vector<std::optional<U>> && partial) mutable {
+        U acc = std::move(init);
+        for (auto & p : partial)
+          if (p) acc = op(std::move(acc), std::move(*p));
+        return acc;
+      });
+}
+
+/**
+ * @brief Returns a sender sorting `s` in parallel on `sched`.
+ *
+ * `s` is cut into up to 64 runs (a power of two), which are sorted concurrently and then merged
+ * pairwise, level by level, each level also in parallel. If `cmp` throws, the sender completes
+ * with the exception and `s` is left permuted.
+ */
+template<Scheduler Sch, typename T, typename Cmp = std::less<>>
+requires std::is_move_constructible_v<T> && std::is_move_assignable_v<T>
+auto bulk_sort(Sch sched, Slice<T> & s, Cmp cmp = Cmp()) {
+  constexpr size_t MAX_RUNS = 64;
+  T * a = s.data();
+  const size_t n = s.size();
+  const size_t runs = std::bit_floor(std::clamp<size_t>(std::min(n / 2048, 2 * sched.concurrency()), 1, MAX_RUNS));
+  auto bound = [n, runs](size_t r) { return n * r / runs; };
+  auto level = [a, runs, bound, cmp](size_t width) {
+    return bulk(width < runs ? runs / (2 * width) : 0, [a, width, bound, cmp](size_t k) {
+      const size_t lo = 2 * k * width;
+      std::inplace_merge(a + bound(lo), a + bound(lo + width), a + bound(lo + 2 * width), cmp);
+    });
+  };
+  return schedule(sched)
+    | bulk(runs, [a, bound, cmp](size_t r) { std::sort(a + bound(r), a + bound(r + 1), cmp); })
+    | level(1) | level(2) | level(4) | level(8) | level(16) | level(32);
+}
+
+/**
+ * @brief The fewest bytes worth a partition of a parallel construction.
+ */
+#ifndef SLICE_PARALLEL_GRAIN_BYTES
+#define SLICE_PARALLEL_GRAIN_BYTES (size_t(64) << 10)
+#endif
+
+/**
+ * @brief Returns the scheduler of `exec`, a `ThreadPool` or a scheduler.
+ */
+template<typename E>
+auto scheduler_of(E & exec) {
+  if constexpr (requires { exec.scheduler(); }) return exec.scheduler();
+  else return exec;
+}
+
+/**
+ * @brief Constructs the `n` elements at `dst`, cut into partitions constructed concurrently on
+ *        `sched`.
+ *
+ * `part(dst, lo, hi)` must construct the elements `[lo, hi)`, or destroy the ones it constructed
+ * and throw. If any partition fails, the others are destroyed once they are all done, and the
+ * first exception is propagated.
+ */
+template<typename T, Scheduler Sch>
+void construct_parallel(T * dst, size_t n, Sch sched, auto && part) {
+  if (n == 0) return;
+  const size_t grain = std::max<size_t>(1, SLICE_PARALLEL_GRAIN_BYTES / sizeof(T));
+  const size_t parts = std::max<size_t>(1, std::min(n / grain, 4 * sched.concurrency()));
+  if (parts == 1) return part(dst, size_t(0), n);
+  std::vector<unsigned char> built(parts, 0);
+  try {
+    sync_wait(schedule(sched) | bulk(parts, [&](size_t k) {
+      part(dst, n * k / parts, n * (k + 1) / parts);
+      built[k] = 1;
+    }));
+  } catch (...) {
+    if constexpr (!Destructible<T>)
+      for (size_t k = 0; k < parts; ++k)
+        if (built[k]) std::destroy(dst + n * k / parts, dst + n * (k + 1) / parts);
+    throw;
+  }
+}
+
+template<typename T>
+template<typename R, typename E>
+Slice<T> Slice<T>::from_parallel(R && r, E && exec) {
+  static_assert(std::ranges::random_access_range<R> && std::ranges::sized_range<R>,
+                "from_parallel needs a sized random-access range");
+  static_assert(std::constructible_from<T, std::ranges::range_reference_t<R>>,
+                "from_parallel needs a range of elements T can be constructed from");
+  const size_t n = static_cast<size_t>(std::ranges::size(r));
+  Slice<T> s(n);
+  const auto first = std::ranges::begin(r);
+  s.append_with(n, [&](T * dst, size_t count) {
+    construct_parallel(dst, count, scheduler_of(exec), [&](T * d, size_t lo, size_t hi) {
+      std::uninitialized_copy_n(first + static_cast<std::ranges::range_difference_t<R>>(lo), hi - lo, d + lo);
+    });
+  });
+  return s;
+}
+
+template<typename T>
+template<typename E>
+void Slice<T>::parallel_fill(size_t n, const T & value, E && exec) {
+  append_with(n, [&](T * dst, size_t count) {
+    bool stream = false;
+    if constexpr (std::is_trivially_copyable_v<T>) stream = StreamStore::worth(count * sizeof(T));
+    construct_parallel(dst, count, scheduler_of(exec), [&](T * d, size_t lo, size_t hi) {
+      if constexpr (std::is_trivially_copyable_v<T>)
+        if (stream) return StreamStore::fill(d + lo, hi - lo, value);
+      std::uninitialized_fill_n(d + lo, hi - lo, value);
+    });
+  });
+}
+
+template<typename T>
+template<typename E>
+void Slice<T>::parallel_copy(const T * src, size_t n, E && exec) {
+  append_with(n, [&](T * dst, size_t count) {
+    bool stream = false;
+    if constexpr (std::is_trivially_copyable_v<T>) stream = StreamStore::worth(count * sizeof(T));
+    construct_parallel(dst, count, scheduler_of(exec), [&](T * d, size_t lo, size_t hi) {
+      if constexpr (std::is_trivially_copyable_v<T>)
+        if (stream) return StreamStore::copy(d + lo, src + lo, (hi - lo) * sizeof(T));
+      std::uninitialized_copy_n(src + lo, hi - lo, d + lo);
+    });
+  });
+}
+
+#endif // EXECUTION_HXX
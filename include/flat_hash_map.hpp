@@ -0,0 +1,352 @@
+#ifndef FLAT_HASH_MAP_HXX
+#define FLAT_HASH_MAP_HXX
+
+#include <cppslice.hpp>
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @class FlatHashMap
+ * @brief An open-addressing hash map with SIMD-probed control bytes, stored in `Slice`s.
+ *
+ * A `FlatHashMap` follows the design of Swiss tables: every slot has a control byte, either
+ * `EMPTY` or the low 7 bits of the hash of its key, kept in a separate `Slice` so that a probe
+ * compares 16 control bytes at once (with SSE2 where available, with SWAR arithmetic otherwise)
+ * and only touches the slots whose control byte matches. Slots are probed linearly from the home
+ * slot of a key, which allows erasing by backward shifting the following entries instead of
+ * leaving tombstones behind. Rehashing relocates the entries through `Slice::relocate`, which is
+ * a plain `memcpy` for trivially copyable entries.
+ *
+ * @note For more information about Swiss tables, refer to
+ *       [Abseil's design notes](https://abseil.io/about/design/swisstables).
+ *
+ * @tparam K The type of the keys.
+ * @tparam V The type of the values.
+ * @tparam Hash The hash function of the keys.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>>
+requires std::equality_comparable<K>
+class FlatHashMap {
+public:
+
+  /**
+   * @brief An entry of the map.
+   */
+  struct Entry {
+    K key;   ///< The key of the entry.
+    V value; ///< The value mapped by `key`.
+  };
+
+private:
+
+  static constexpr size_t GROUP = 16;                    ///< The control bytes compared at once.
+  static constexpr int8_t EMPTY = -128;                  ///< The control byte of an empty slot.
+  static constexpr size_t NPOS = static_cast<size_t>(-1); ///< The index of a missing entry.
+
+  Slice<int8_t> ctrl_; ///< The control bytes, followed by a copy of the first `GROUP - 1` ones.
+  Slice<Entry> slots_; ///< The storage of the entries, of which only the full slots are alive.
+  size_t mask_;        ///< The capacity minus one, the capacity being a power of two.
+  size_t size_;        ///< The number of entries.
+
+  /*–
+   * AF: the map {slots_[i].key ↦ slots_[i].value | ctrl_[i] ≠ EMPTY}.
+   *
+   * ---
+   *
+   * RI: - slots_.capacity() is 0 or a power of two not lower than GROUP
+   *     - ctrl_.size() = slots_.capacity() + GROUP - 1 if slots_.capacity() > 0, 0 otherwise
+   *     - ctrl_[cap + i] = ctrl_[i] for every i < GROUP - 1
+   *     - ctrl_[i] ≠ EMPTY ⇒ ctrl_[i] = h2(slots_[i].key)
+   *     - every slot between the home slot of an entry and the entry itself is full
+   *     - size_ ≤ 7/8 · capacity
+   */
+
+  /**
+   * @brief Hashes `k`, scrambling the bits of weak hash functions such as the identity.
+   */
+  static uint64_t hash(const K & k) noexcept(noexcept(Hash{}(k))) {
+    uint64_t h = static_cast<uint64_t>(Hash{}(k));
+    h ^= h >> 33, h *= 0xff51afd7ed558ccdULL, h ^= h >> 33;
+    return h;
+  }
+
+  /**
+   * @brief Returns the control byte of an entry, given its hash.
+   */
+  static int8_t h2(uint64_t h) noexcept { return static_cast<int8_t>(h & 0x7f); }
+
+  /**
+   * @brief Returns the home slot of an entry, given its hash.
+   */
+  size_t home(uint64_t h) const noexcept { return (h >> 7) & mask_; }
+
+  /**
+   * @brief Compares `GROUP` control bytes with `c`.
+   *
+   * @param g The first control byte.
+   * @param c The control byte to look for.
+   * @return A mask whose bit i is set if `g[i] = c`. The portable version may also set some
+   *         bits above a matching byte; probes check the keys anyway.
+   */
+  static uint32_t match(const int8_t * g, int8_t c) noexcept {
+#if defined(__SSE2__)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+#else
+    constexpr uint64_t LSB = 0x0101010101010101ULL, MSB = 0x8080808080808080ULL;
+    uint64_t w[2];
+    std::memcpy(w, g, sizeof(w));
+    uint32_t m = 0;
+    for (size_t i = 0; i < 2; ++i) {
+      uint64_t x = w[i] ^ (LSB * static_cast<uint8_t>(c));
+      m |= squeeze((x - LSB) & ~x & MSB) << (8 * i);
+    }
+    return m;
+#endif
+  }
+
+  /**
+   * @brief Looks for empty slots among `GROUP` control bytes.
+   *
+   * @param g The first control byte.
+   * @return A mask whose bit i is set if and only if `g[i] = EMPTY`.
+   */
+  static uint32_t match_empty(const int8_t * g) noexcept {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(g))));
+#else
+    constexpr uint64_t MSB = 0x8080808080808080ULL;
+    uint64_t w[2];
+    std::memcpy(w, g, sizeof(w));
+    return squeeze(w[0] & MSB) | squeeze(w[1] & MSB) << 8;
+#endif
+  }
+
+  /**
+   * @brief Packs the most significant bit of each byte of `x` into the low 8 bits.
+   */
+  static constexpr uint32_t squeeze(uint64_t x) noexcept {
+    return static_cast<uint32_t>(((x >> 7) * 0x0102040810204080ULL) >> 56);
+  }
+
+  /**
+   * @brief Sets the control byte of slot `i`, keeping the trailing copy in sync.
+   */
+  void set_ctrl(size_t i, int8_t c) noexcept {
+    ctrl_.data()[i] = c;
+    if (i < GROUP - 1) ctrl_.data()[mask_ + 1 + i] = c;
+  }
+
+  /**
+   * @brief Finds the slot holding `k`, or `NPOS` if there is none.
+   */
+  size_t find_index(const K & k) const {
+    if (size_ == 0) return NPOS;
+    const uint64_t h = hash(k);
+    for (size_t pos = home(h);; pos = (pos + GROUP) & mask_) {
+      const int8_t * g = ctrl_.data() + pos;
+      for (uint32_t m = match(g, h2(h)); m; m &= m - 1) {
+        const size_t i = (pos + static_cast<size_t>(std::countr_zero(m))) & mask_;
+        if (slots_.data()[i].key == k) return i;
+      }
+      if (match_empty(g)) return NPOS;
+    }
+  }
+
+  /**
+   * @brief Finds the first empty slot probing from slot `pos`.
+   */
+  size_t find_empty(size_t pos) const noexcept {
+    for (;; pos = (pos + GROUP) & mask_)
+      if (uint32_t m = match_empty(ctrl_.data() + pos)) return (pos + static_cast<size_t>(std::countr_zero(m))) & mask_;
+  }
+
+  /**
+   * @brief Returns the smallest capacity that holds `n` entries within the maximum load factor.
+   */
+  static size_t capacity_for(size_t n) noexcept {
+    size_t cap = GROUP;
+    while (cap / 8 * 7 < n) cap *= 2;
+    return cap;
+  }
+
+  /**
+   * @brief Moves the entries of `this` into a table of the given capacity.
+   *
+   * Entries that relocate without throwing are relocated through `Slice::relocate`; the others
+   * are copied, so that `this` is left untouched if a copy throws.
+   */
+  void rehash(size_t cap) {
+    FlatHashMap other(cap / 8 * 7);
+    for (size_t i = 0; i <= mask_ && size_ > 0; ++i) {
+      if (ctrl_.data()[i] == EMPTY) continue;
+      Entry & e = slots_.data()[i];
+      const uint64_t h = hash(e.key);
+      const size_t j = other.find_empty(other.home(h));
+      if constexpr (std::is_trivially_copyable_v<Entry> || std::is_nothrow_move_constructible_v<Entry>) {
+        Slice<Entry>::relocate(other.slots_.data() + j, &e, 1);
+      } else {
+        new (other.slots_.data() + j) Entry(std::as_const(e));
+      }
+      other.set_ctrl(j, h2(h));
+      ++other.size_;
+    }
+    if constexpr (std::is_trivially_copyable_v<Entry> || std::is_nothrow_move_constructible_v<Entry>) {
+      if (size_ > 0) std::memset(ctrl_.data(), EMPTY, ctrl_.size());
+    }
+    swap(other);
+  }
+
+  /**
+   * @brief Destroys every entry of `this`, leaving the control bytes as they are.
+   */
+  void destroy_entries() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<Entry>) {
+      for (size_t i = 0; i < ctrl_.size() && i <= mask_; ++i)
+        if (ctrl_.data()[i] != EMPTY) slots_.data()[i].~Entry();
+    }
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`, without allocating.
+   */
+  FlatHashMap() : ctrl_(), slots_(), mask_(0), size_(0) {}
+
+  /**
+   * @brief Size constructor.
+   *
+   * Creates an empty `this` that can hold `n` entries without rehashing.
+   *
+   * @param n The number of entries to make room for.
+   *
+   * @throws Any exception that may be thrown during the allocation.
+   */
+  explicit FlatHashMap(size_t n) : ctrl_(capacity_for(n) + GROUP - 1), slots_(capacity_for(n)), mask_(0), size_(0) {
+    mask_ = slots_.capacity() - 1;
+    for (size_t i = 0; i < ctrl_.capacity(); ++i) ctrl_.append(EMPTY);
+  }
+
+  FlatHashMap(FlatHashMap && o) noexcept : FlatHashMap() { swap(o); }
+
+  FlatHashMap & operator=(FlatHashMap && o) noexcept {
+    FlatHashMap tmp(std::move(o));
+    swap(tmp);
+    return *this;
+  }
+
+  FlatHashMap(const FlatHashMap &) = delete;
+  FlatHashMap & operator=(const FlatHashMap &) = delete;
+
+  /**
+   * @brief Swaps the contents of `this` and `o`.
+   */
+  void swap(FlatHashMap & o) noexcept {
+    std::swap(ctrl_, o.ctrl_), std::swap(slots_, o.slots_);
+    std::swap(mask_, o.mask_), std::swap(size_, o.size_);
+  }
+
+  /**
+   * @brief Returns the number of entries in `this`.
+   */
+  size_t size() const noexcept { return size_; }
+
+  /**
+   * @brief Returns the number of slots of `this`.
+   */
+  size_t capacity() const noexcept { return slots_.capacity(); }
+
+  /**
+   * @brief Finds the value mapped by `k`.
+   *
+   * @param k The key to search for.
+   * @return A pointer to the value mapped by `k`, or `nullptr` if `k` is not in `this`.
+   */
+  V * find(const K & k) {
+    size_t i = find_index(k);
+    return i == NPOS ? nullptr : &slots_.data()[i].value;
+  }
+
+  const V * find(const K & k) const { return const_cast<FlatHashMap *>(this)->find(k); }
+
+  /**
+   * @brief Checks whether `k` is mapped by `this`.
+   */
+  bool contains(const K & k) const { return find_index(k) != NPOS; }
+
+  /**
+   * @brief Makes room for `n` entries without rehashing.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void reserve(size_t n) {
+    if (capacity_for(n) > capacity()) rehash(capacity_for(n));
+  }
+
+  /**
+   * @brief Inserts an entry in `this`, unless its key is already mapped.
+   *
+   * @param k The key of the entry.
+   * @param v The value of the entry.
+   * @return `true` if the entry was inserted, `false` if `k` was already mapped.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  bool insert(K k, V v) {
+    if (find_index(k) != NPOS) return false;
+    if (capacity() / 8 * 7 < size_ + 1) rehash(capacity() ? 2 * capacity() : GROUP);
+    const uint64_t h = hash(k);
+    const size_t i = find_empty(home(h));
+    new (slots_.data() + i) Entry{std::move(k), std::move(v)};
+    set_ctrl(i, h2(h));
+    ++size_;
+    return true;
+  }
+
+  /**
+   * @brief Removes the entry of `k` from `this`, if any.
+   *
+   * The entries that follow the removed one in its probe sequence are shifted back by one slot
+   * when that brings them closer to their home slot, so no tombstone is left behind.
+   *
+   * @param k The key of the entry to remove.
+   * @return `true` if an entry was removed, `false` if `k` was not mapped.
+   */
+  bool erase(const K & k) {
+    size_t i = find_index(k);
+    if (i == NPOS) return false;
+    slots_.data()[i].~Entry();
+    for (size_t j = (i + 1) & mask_; ctrl_.data()[j] != EMPTY; j = (j + 1) & mask_) {
+      const size_t h = home(hash(slots_.data()[j].key));
+      if (((i - h) & mask_) < ((j - h) & mask_)) {
+        Slice<Entry>::relocate(slots_.data() + i, slots_.data() + j, 1);
+        set_ctrl(i, ctrl_.data()[j]);
+        i = j;
+      }
+    }
+    set_ctrl(i, EMPTY);
+    --size_;
+    return true;
+  }
+
+  /**
+   * @brief Destructor.
+   *
+   * Destroys the live entries; the storage is released by the underlying `Slice`s.
+   */
+  ~FlatHashMap() noexcept { destroy_entries(); }
+};
+
+#endif // FLAT_HASH_MAP_HXX
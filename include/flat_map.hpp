@@ -0,0 +1,336 @@
+#ifndef FLAT_MAP_HXX
+#define FLAT_MAP_HXX
+
+#include <cppslice.hpp>
+#include <search_index.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class FlatIndex
+ * @brief The lookup structure used by flat containers over sorted keys of type `K`.
+ *
+ * Non-arithmetic keys need no extra structure and are searched with a binary search over the
+ * sorted keys; arithmetic keys are searched through a `SearchIndex` instead.
+ *
+ * @tparam K The type of the keys.
+ */
+template<typename K>
+class FlatIndex {
+public:
+
+  explicit FlatIndex(const Slice<K> &) noexcept {}
+
+  size_t lower_bound(const Slice<K> & keys, const K & k) const {
+    return static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), k) - keys.begin());
+  }
+};
+
+template<typename K>
+requires std::is_arithmetic_v<K>
+class FlatIndex<K> {
+private:
+
+  SearchIndex<K> index_; ///< The search index over the keys.
+
+public:
+
+  explicit FlatIndex(const Slice<K> & keys) : index_(keys) {}
+
+  size_t lower_bound(const Slice<K> &, const K & k) const noexcept { return index_.lower_bound(k); }
+};
+
+/**
+ * @brief Finds where the sorted, unique `delta` merges into the sorted, unique `keys`.
+ *
+ * Only compares keys, so that a merge can run its comparisons before it moves anything.
+ *
+ * @return For each key of `delta`, the number of keys of `keys` lower than it, or `SIZE_MAX` if
+ *         `keys` already holds it.
+ *
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename K>
+Slice<size_t> merge_positions(const Slice<K> & keys, const Slice<K> & delta) {
+  Slice<size_t> pos(delta.size());
+  size_t i = 0;
+  for (const K & k : delta) {
+    while (i < keys.size() && keys.data()[i] < k) ++i;
+    pos.append(i < keys.size() && !(k < keys.data()[i]) ? SIZE_MAX : i);
+  }
+  return pos;
+}
+
+/**
+ * @class FlatSet
+ * @brief A sorted set of unique keys stored contiguously in a `Slice`.
+ *
+ * A `FlatSet` keeps its keys sorted in a single `Slice`, trading the O(log n) insertions of a
+ * node-based set for cache-friendly lookups: it is meant for read-mostly sets that are built in
+ * bulk and updated in batches. Lookups go through a `SearchIndex` when the keys are arithmetic.
+ *
+ * @tparam K The type of the keys, which must be ordered by `operator<`.
+ */
+template<typename K>
+requires std::totally_ordered<K>
+class FlatSet {
+private:
+
+  Slice<K> keys_;       ///< The keys of `this`, sorted and unique.
+  FlatIndex<K> index_;  ///< The search index over `keys_`.
+
+  /*–
+   * AF: the set {keys_[0], …, keys_[keys_.size() - 1]}.
+   *
+   * ---
+   *
+   * RI: - keys_ is strictly increasing
+   *     - index_ indexes exactly the keys of keys_
+   */
+
+  /**
+   * @brief Sorts the keys of `s` and drops the duplicates, keeping the first occurrence.
+   */
+  static Slice<K> sort_unique(Slice<K> && s) {
+    std::stable_sort(s.begin(), s.end());
+    Slice<K> out(s.size());
+    for (K & k : s)
+      if (out.size() == 0 || out.data()[out.size() - 1] < k) out.append(std::move(k));
+    return out;
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  FlatSet() : keys_(), index_(keys_) {}
+
+  /**
+   * @brief Iterable constructor.
+   *
+   * Creates `this` from an unsorted collection of keys, which can be either copied or moved.
+   * The keys are sorted and deduplicated in a single pass.
+   *
+   * @param c The collection of keys.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  explicit FlatSet(auto && c) requires Iterable<K, decltype(c)>
+      : keys_(sort_unique(Slice<K>(std::forward<decltype(c)>(c)))), index_(keys_) {}
+
+  /**
+   * @brief Returns the number of keys in `this`.
+   */
+  size_t size() const noexcept { return keys_.size(); }
+
+  /**
+   * @brief Returns the sorted keys of `this`.
+   */
+  const Slice<K> & keys() const noexcept { return keys_; }
+
+  /**
+   * @brief Finds the position of the first key that is not lower than `k`.
+   *
+   * @param k The key to search for.
+   * @return The position of the first key not lower than `k`, or `size()` if there is none.
+   */
+  size_t lower_bound(const K & k) const { return index_.lower_bound(keys_, k); }
+
+  /**
+   * @brief Checks whether `k` belongs to `this`.
+   */
+  bool contains(const K & k) const {
+    size_t i = lower_bound(k);
+    return i < keys_.size() && !(k < keys_.data()[i]);
+  }
+
+  /**
+   * @brief Inserts a batch of keys in `this`.
+   *
+   * Sorts and deduplicates the batch, then merges it with the keys of `this` in one linear pass
+   * and rebuilds the index once, so that inserting m keys costs O(m log m + n) rather than m
+   * separate O(n) shifts.
+   *
+   * Every comparison runs before the merge, and the keys of `this` are moved only if that cannot
+   * throw (they are copied otherwise), so that `this` is left untouched if an exception is thrown,
+   * unless `K` can only be moved, with a move that may throw.
+   *
+   * @param c The unsorted collection of keys to insert.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void insert(auto && c) requires Iterable<K, decltype(c)> {
+    Slice<K> delta = sort_unique(Slice<K>(std::forward<decltype(c)>(c)));
+    const Slice<size_t> pos = merge_positions(keys_, delta);
+    Slice<K> merged(keys_.size() + delta.size());
+    size_t i = 0;
+    for (size_t j = 0; j < delta.size(); ++j) {
+      if (pos.data()[j] == SIZE_MAX) continue;
+      for (; i < pos.data()[j]; ++i) merged.append(std::move_if_noexcept(keys_.data()[i]));
+      merged.append(std::move(delta.data()[j]));
+    }
+    for (; i < keys_.size(); ++i) merged.append(std::move_if_noexcept(keys_.data()[i]));
+    FlatIndex<K> index(merged);
+    keys_ = std::move(merged), index_ = std::move(index);
+  }
+};
+
+/**
+ * @class FlatMap
+ * @brief A sorted map stored contiguously in two `Slice`s, one for keys and one for values.
+ *
+ * A `FlatMap` keeps its keys sorted in one `Slice` and the matching values in another one
+ * (structure of arrays), so that lookups only stream through keys and touch a single value.
+ * Like `FlatSet`, it is meant for read-mostly dictionaries built in bulk and updated in batches,
+ * and searches arithmetic keys through a `SearchIndex`.
+ *
+ * @tparam K The type of the keys, which must be ordered by `operator<`.
+ * @tparam V The type of the values.
+ */
+template<typename K, typename V>
+requires std::totally_ordered<K>
+class FlatMap {
+private:
+
+  Slice<K> keys_;       ///< The keys of `this`, sorted and unique.
+  Slice<V> vals_;       ///< The values of `this`, `vals_[i]` mapped by `keys_[i]`.
+  FlatIndex<K> index_;  ///< The search index over `keys_`.
+
+  /*–
+   * AF: the map {keys_[i] ↦ vals_[i] | 0 ≤ i < keys_.size()}.
+   *
+   * ---
+   *
+   * RI: - keys_ is strictly increasing
+   *     - keys_.size() = vals_.size()
+   *     - index_ indexes exactly the keys of keys_
+   */
+
+  /**
+   * @brief Sorts the entries of `s` by key and splits them into keys and values.
+   *
+   * Duplicate keys keep the value of their first occurrence.
+   */
+  static std::pair<Slice<K>, Slice<V>> sort_unique(Slice<std::pair<K, V>> && s) {
+    std::stable_sort(s.begin(), s.end(), [](const auto & l, const auto & r) { return l.first < r.first; });
+    std::pair<Slice<K>, Slice<V>> out(Slice<K>(s.size()), Slice<V>(s.size()));
+    for (auto & [k, v] : s) {
+      if (out.first.size() > 0 && !(out.first.data()[out.first.size() - 1] < k)) continue;
+      out.first.append(std::move(k));
+      out.second.append(std::move(v));
+    }
+    return out;
+  }
+
+  /**
+   * @brief Rebuilds the search index after `keys_` changed.
+   */
+  void reindex() { index_ = FlatIndex<K>(keys_); }
+
+  /**
+   * @brief Finds the position of the first key that is not lower than `k`.
+   */
+  size_t lower_bound(const K & k) const { return index_.lower_bound(keys_, k); }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  FlatMap() : keys_(), vals_(), index_(keys_) {}
+
+  /**
+   * @brief Iterable constructor.
+   *
+   * Creates `this` from an unsorted collection of key-value pairs, which can be either copied or
+   * moved. The entries are sorted and deduplicated in a single pass; duplicate keys keep the
+   * value of their first occurrence.
+   *
+   * @param c The collection of entries.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  explicit FlatMap(auto && c) requires Iterable<std::pair<K, V>, decltype(c)> : FlatMap() {
+    auto [keys, vals] = sort_unique(Slice<std::pair<K, V>>(std::forward<decltype(c)>(c)));
+    keys_ = std::move(keys), vals_ = std::move(vals);
+    reindex();
+  }
+
+  /**
+   * @brief Returns the number of entries in `this`.
+   */
+  size_t size() const noexcept { return keys_.size(); }
+
+  /**
+   * @brief Returns the sorted keys of `this`.
+   */
+  const Slice<K> & keys() const noexcept { return keys_; }
+
+  /**
+   * @brief Returns the values of `this`, in the order of their keys.
+   */
+  const Slice<V> & values() const noexcept { return vals_; }
+
+  /**
+   * @brief Finds the value mapped by `k`.
+   *
+   * @param k The key to search for.
+   * @return A pointer to the value mapped by `k`, or `nullptr` if `k` is not in `this`.
+   */
+  V * find(const K & k) {
+    size_t i = lower_bound(k);
+    return i < keys_.size() && !(k < keys_.data()[i]) ? vals_.data() + i : nullptr;
+  }
+
+  const V * find(const K & k) const { return const_cast<FlatMap *>(this)->find(k); }
+
+  /**
+   * @brief Checks whether `k` is mapped by `this`.
+   */
+  bool contains(const K & k) const { return find(k) != nullptr; }
+
+  /**
+   * @brief Inserts a batch of entries in `this`.
+   *
+   * Sorts and deduplicates the batch, then merges it with the entries of `this` in one linear
+   * pass and rebuilds the index once. Keys already in `this` keep their current value.
+   *
+   * As with `FlatSet::insert()`, the entries of `this` are moved only once every comparison ran,
+   * and only if that cannot throw, so that `this` is left untouched if an exception is thrown,
+   * unless `K` or `V` can only be moved, with a move that may throw.
+   *
+   * @param c The unsorted collection of entries to insert.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void insert(auto && c) requires Iterable<std::pair<K, V>, decltype(c)> {
+    auto [dkeys, dvals] = sort_unique(Slice<std::pair<K, V>>(std::forward<decltype(c)>(c)));
+    const Slice<size_t> pos = merge_positions(keys_, dkeys);
+    const size_t n = keys_.size(), m = dkeys.size();
+    Slice<K> keys(n + m);
+    Slice<V> vals(n + m);
+    size_t i = 0;
+    auto keep = [&](size_t end) {
+      for (; i < end; ++i)
+        keys.append(std::move_if_noexcept(keys_.data()[i])), vals.append(std::move_if_noexcept(vals_.data()[i]));
+    };
+    for (size_t j = 0; j < m; ++j) {
+      if (pos.data()[j] == SIZE_MAX) continue;
+      keep(pos.data()[j]);
+      keys.append(std::move(dkeys.data()[j])), vals.append(std::move(dvals.data()[j]));
+    }
+    keep(n);
+    FlatIndex<K> index(keys);
+    keys_ = std::move(keys), vals_ = std::move(vals), index_ = std::move(index);
+  }
+};
+
+#endif // FLAT_MAP_HXX
@@ -0,0 +1,343 @@
+#ifndef GATHER_HXX
+#define GATHER_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Index-based gather (`out[i] = src[idx[i]]`), scatter (`dst[idx[i]] = val[i]`) and permutation
+ * kernels over slices. The pointer kernels are unchecked; the `Slice` overloads check the indices
+ * first, in one sequential pass that costs little next to the random accesses it guards.
+ *
+ * Random accesses are latency bound, so the kernels prefetch the element `distance` positions
+ * ahead (`SLICE_PREFETCH_DISTANCE` by default). 4- and 8-byte trivially copyable elements are
+ * moved with hardware gathers (and, with AVX-512, scatters), where available. When the source
+ * (or destination) is much larger than the caches, the partitioned variants first group the
+ * positions by block of the source (or destination), so that each block is accessed while it is
+ * cached, at the cost of one extra pass over the indices.
+ */
+
+#ifndef SLICE_PREFETCH_DISTANCE
+#define SLICE_PREFETCH_DISTANCE 16
+#endif
+
+#ifndef SLICE_GATHER_BLOCK_BYTES
+#define SLICE_GATHER_BLOCK_BYTES (size_t(256) << 10)
+#endif
+
+/**
+ * @brief Whether the elements of `T` can be moved by the hardware gathers and scatters.
+ */
+template<typename T, typename Index>
+concept SimdGatherable = std::is_trivially_copyable_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)
+  && (sizeof(Index) == 4 || sizeof(Index) == 8);
+
+#if defined(__AVX2__)
+/**
+ * @brief Loads `W` indices at `idx`, zero-extended to 64 bits.
+ */
+template<size_t W, typename Index>
+inline auto gather_load_indices(const Index * idx) noexcept {
+  if constexpr (W == 8) {
+#if defined(__AVX512F__)
+    if constexpr (sizeof(Index) == 8) return _mm512_loadu_si512(idx);
+    else return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx)));
+#endif
+  } else {
+    if constexpr (sizeof(Index) == 8) return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx));
+    else return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(idx)));
+  }
+}
+#endif
+
+/**
+ * @brief Gathers `out[i] = src[idx[i]]` for `0 ≤ i < n`, without bounds checks.
+ *
+ * @param out The destination, of `n` elements, not overlapping `src`.
+ * @param src The source.
+ * @param idx The `n` positions in `src`.
+ * @param n The number of elements to gather.
+ * @param distance How many positions ahead to prefetch, 0 to disable prefetching.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_copy_assignable_v<T>
+void gather(T * out, const T * src, const Index * idx, size_t n, size_t distance = SLICE_PREFETCH_DISTANCE) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  if constexpr (SimdGatherable<T, Index>) {
+#if defined(__AVX512F__)
+    constexpr size_t W = 8;
+#else
+    constexpr size_t W = 4;
+#endif
+    for (; i + W <= n; i += W) {
+      if (distance && i + distance + W <= n)
+        for (size_t k = 0; k < W; ++k) __builtin_prefetch(src + idx[i + distance + k]);
+      const auto vi = gather_load_indices<W>(idx + i);
+#if defined(__AVX512F__)
+      if constexpr (sizeof(T) == 8) _mm512_storeu_si512(out + i, _mm512_i64gather_epi64(vi, src, 8));
+      else _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_i64gather_epi32(vi, src, 4));
+#else
+      if constexpr (sizeof(T) == 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm256_i64gather_epi64(reinterpret_cast<const long long *>(src), vi, 8));
+      else
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm256_i64gather_epi32(reinterpret_cast<const int *>(src), vi, 4));
+#endif
+    }
+  }
+#endif
+  if (distance)
+    for (; i + distance < n; ++i) __builtin_prefetch(src + idx[i + distance]), out[i] = src[idx[i]];
+  for (; i < n; ++i) out[i] = src[idx[i]];
+}
+
+/**
+ * @brief Scatters `dst[idx[i]] = val[i]` for `0 ≤ i < n`, in order, without bounds checks.
+ *
+ * When two positions are equal, the later element is the one kept.
+ *
+ * @param dst The destination.
+ * @param idx The `n` positions in `dst`.
+ * @param val The `n` elements to scatter, not overlapping `dst`.
+ * @param n The number of elements to scatter.
+ * @param distance How many positions ahead to prefetch, 0 to disable prefetching.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_copy_assignable_v<T>
+void scatter(T * dst, const Index * idx, const T * val, size_t n, size_t distance = SLICE_PREFETCH_DISTANCE) {
+  size_t i = 0;
+#if defined(__AVX512F__)
+  if constexpr (SimdGatherable<T, Index>) {
+    for (; i + 8 <= n; i += 8) {
+      if (distance && i + distance + 8 <= n)
+        for (size_t k = 0; k < 8; ++k) __builtin_prefetch(dst + idx[i + distance + k], 1);
+      const __m512i vi = gather_load_indices<8>(idx + i);
+      if constexpr (sizeof(T) == 8) _mm512_i64scatter_epi64(dst, vi, _mm512_loadu_si512(val + i), 8);
+      else _mm512_i64scatter_epi32(dst, vi, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(val + i)), 4);
+    }
+  }
+#endif
+  if (distance)
+    for (; i + distance < n; ++i) __builtin_prefetch(dst + idx[i + distance], 1), dst[idx[i]] = val[i];
+  for (; i < n; ++i) dst[idx[i]] = val[i];
+}
+
+/**
+ * @brief Returns the shift of the blocks a partitioned kernel splits `bound` elements into.
+ *
+ * Blocks hold a power of two elements, at least `block`, and there are at most 256 of them, so
+ * that partitioning writes to few enough streams at once.
+ */
+inline unsigned block_shift(size_t bound, size_t block) noexcept {
+  constexpr size_t MAX_BLOCKS = 256;
+  return static_cast<unsigned>(std::countr_zero(std::bit_ceil(std::max({block, (bound + MAX_BLOCKS - 1) / MAX_BLOCKS, size_t(1)}))));
+}
+
+/**
+ * @brief Partitions `pair(i)` for `0 ≤ i < n` by the block of `key(i)`, keeping their order.
+ *
+ * @param shift The shift of the blocks.
+ * @param blocks The number of blocks.
+ * @return The pairs, block by block.
+ *
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename Pair>
+Slice<Pair> partition_by_block(size_t n, unsigned shift, size_t blocks, auto && key, auto && pair) {
+  Slice<size_t> cursor(blocks + 1);
+  for (size_t b = 0; b <= blocks; ++b) cursor.append(size_t(0));
+  size_t * c = cursor.data();
+  for (size_t i = 0; i < n; ++i) ++c[(key(i) >> shift) + 1];
+  for (size_t b = 0; b < blocks; ++b) c[b + 1] += c[b];
+  Slice<Pair> out(n);
+  out.append_with(n, [&](Pair * p, size_t) {
+    for (size_t i = 0; i < n; ++i) p[c[key(i) >> shift]++] = pair(i);
+  });
+  return out;
+}
+
+/**
+ * @brief Gathers like `gather()`, touching `src` and `out` one cached block at a time.
+ *
+ * Worth it when `src` and `out` are much larger than the last-level cache and `idx` is random:
+ * instead of one cache (and TLB) miss per element, the requests are partitioned by block of
+ * `src`, answered block by block, and the replies partitioned by block of `out` before being
+ * written, so that every pass is sequential or stays within a block (of `block` elements,
+ * about the size of L2 by default). It needs two buffers of `n` pairs, and moves about four
+ * times the data of `gather()`, so whether it pays off depends on the machine's miss latency.
+ *
+ * @param src_n The number of elements of `src`, above every position in `idx`.
+ *
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_trivially_copyable_v<T>
+void gather_partitioned(T * out, const T * src, size_t src_n, const Index * idx, size_t n,
+                        size_t block = SLICE_GATHER_BLOCK_BYTES / sizeof(T)) {
+  if (src_n <= block || n == 0) return gather(out, src, idx, n);
+  struct Request { size_t pos; Index at; };
+  struct Reply { size_t pos; T value; };
+  const unsigned ss = block_shift(src_n, block), os = block_shift(n, block);
+  const Slice<Request> req = partition_by_block<Request>(n, ss, ((src_n - 1) >> ss) + 1,
+    [&](size_t i) { return size_t(idx[i]); }, [&](size_t i) { return Request{i, idx[i]}; });
+
+  const size_t out_blocks = ((n - 1) >> os) + 1;
+  Slice<size_t> cursor(out_blocks);
+  for (size_t b = 0; b < out_blocks; ++b) cursor.append(b << os);
+  Slice<Reply> rep(n);
+  rep.append_with(n, [&](Reply * r, size_t) {
+    size_t * c = cursor.data();
+    for (const Request & q : req) r[c[q.pos >> os]++] = Reply{q.pos, src[q.at]};
+  });
+  for (const Reply & r : rep) out[r.pos] = r.value;
+}
+
+/**
+ * @brief Scatters like `scatter()`, touching `dst` one cached block at a time.
+ *
+ * The writes are partitioned by block of `dst` first, in one sequential pass, then applied
+ * block by block; writes to the same position are still applied in order. It needs a buffer
+ * of `n` pairs.
+ *
+ * @param dst_n The number of elements of `dst`, above every position in `idx`.
+ *
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_trivially_copyable_v<T>
+void scatter_partitioned(T * dst, size_t dst_n, const Index * idx, const T * val, size_t n,
+                         size_t block = SLICE_GATHER_BLOCK_BYTES / sizeof(T)) {
+  if (dst_n <= block || n == 0) return scatter(dst, idx, val, n);
+  struct Write { Index at; T value; };
+  const unsigned ds = block_shift(dst_n, block);
+  const Slice<Write> w = partition_by_block<Write>(n, ds, ((dst_n - 1) >> ds) + 1,
+    [&](size_t i) { return size_t(idx[i]); }, [&](size_t i) { return Write{idx[i], val[i]}; });
+  for (const Write & x : w) dst[x.at] = x.value;
+}
+
+/**
+ * @brief Checks that every position in `idx` is below `bound`.
+ *
+ * @throws std::out_of_range If one is not.
+ */
+template<std::unsigned_integral Index>
+void check_indices(const Slice<Index> & idx, size_t bound) {
+  Index hi = 0;
+  for (Index i : idx) hi = i > hi ? i : hi;
+  if (idx.size() > 0 && hi >= bound) throw std::out_of_range("Invalid argument");
+}
+
+/**
+ * @brief Returns the elements of `src` at the positions `idx`, in order.
+ *
+ * @param partitioned Whether to gather block by block, for large sources and random positions.
+ *
+ * @throws std::out_of_range If a position is not valid in `src`.
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_copy_constructible_v<T>
+Slice<T> gather(const Slice<T> & src, const Slice<Index> & idx, bool partitioned = false) {
+  check_indices(idx, src.size());
+  const size_t n = idx.size();
+  Slice<T> out(n);
+  out.append_with(n, [&](T * dst, size_t) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (partitioned) gather_partitioned(dst, src.data(), src.size(), idx.data(), n);
+      else gather(dst, src.data(), idx.data(), n);
+    } else {
+      const T * s = src.data();
+      const Index * x = idx.data();
+      size_t i = 0;
+      try {
+        for (; i < n; ++i) {
+          if (i + SLICE_PREFETCH_DISTANCE < n) __builtin_prefetch(s + x[i + SLICE_PREFETCH_DISTANCE]);
+          new (dst + i) T(s[x[i]]);
+        }
+      } catch (...) {
+        if constexpr (!Destructible<T>) for (size_t j = 0; j < i; ++j) dst[j].~T();
+        throw;
+      }
+    }
+  });
+  return out;
+}
+
+/**
+ * @brief Scatters the elements of `val` to the positions `idx` of `dst`, in order.
+ *
+ * @param partitioned Whether to scatter block by block, for large destinations and random positions.
+ *
+ * @throws std::invalid_argument If `idx` and `val` are not of the same size.
+ * @throws std::out_of_range If a position is not valid in `dst`.
+ * @throws Any exception that may be thrown during the operation.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_copy_assignable_v<T>
+void scatter(Slice<T> & dst, const Slice<Index> & idx, const Slice<T> & val, bool partitioned = false) {
+  if (idx.size() != val.size()) throw std::invalid_argument("Positions and elements of different sizes.");
+  check_indices(idx, dst.size());
+  if constexpr (std::is_trivially_copyable_v<T>)
+    if (partitioned) return scatter_partitioned(dst.data(), dst.size(), idx.data(), val.data(), idx.size());
+  scatter(dst.data(), idx.data(), val.data(), idx.size());
+}
+
+/**
+ * @brief Permutes `s` in place so that `s[i]` becomes the former `s[perm[i]]`.
+ *
+ * Follows the cycles of `perm`, moving every element once through a single temporary, so that
+ * no second buffer of elements is needed; visited positions are tracked in a bitmap of one bit
+ * per element.
+ *
+ * @throws std::invalid_argument If `perm` is not a permutation of the positions of `s`.
+ * @throws Any exception that may be thrown during the operation, before `s` is modified.
+ */
+template<typename T, std::unsigned_integral Index>
+requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+void apply_permutation(Slice<T> & s, const Slice<Index> & perm) {
+  const size_t n = s.size();
+  if (perm.size() != n) throw std::invalid_argument("Permutation of a different size.");
+  const Index * p = perm.data();
+  Slice<uint64_t> seen((n + 63) / 64);
+  for (size_t w = 0; w < (n + 63) / 64; ++w) seen.append(uint64_t(0));
+  uint64_t * m = seen.data();
+  for (size_t i = 0; i < n; ++i) {
+    if (p[i] >= n || (m[p[i] / 64] >> (p[i] % 64) & 1)) throw std::invalid_argument("Not a permutation.");
+    m[p[i] / 64] |= uint64_t(1) << (p[i] % 64);
+  }
+
+  T * a = s.data();
+  for (size_t start = 0; start < n; ++start) {
+    if (!(m[start / 64] >> (start % 64) & 1)) continue;  // set bits mark the positions to visit
+    if (p[start] == start) {
+      m[start / 64] &= ~(uint64_t(1) << (start % 64));
+      continue;
+    }
+    T tmp(std::move(a[start]));
+    size_t j = start;
+    while (true) {
+      m[j / 64] &= ~(uint64_t(1) << (j % 64));
+      const size_t k = p[j];
+      if (k == start) break;
+      a[j] = std::move(a[k]);
+      j = k;
+    }
+    a[j] = std::move(tmp);
+  }
+}
+
+#endif // GATHER_HXX
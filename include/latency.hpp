@@ -0,0 +1,284 @@
+#ifndef LATENCY_HXX
+#define LATENCY_HXX
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The operations of `Slice` whose latency is recorded in instrumented builds.
+ */
+enum class SliceOp : size_t {
+  Construct, ///< Size, Iterable and variadic construction.
+  Append,    ///< Appending an element, including any growth it triggers.
+  Grow,      ///< Reallocating the collection to a larger capacity.
+  SubSlice,  ///< Taking a sub-slice.
+  Destroy,   ///< Destroying the elements and freeing the collection.
+  COUNT
+};
+
+/**
+ * @brief Returns the name of an operation, as reported.
+ */
+constexpr const char * slice_op_name(SliceOp op) noexcept {
+  constexpr const char * NAMES[] = {"construct", "append", "grow", "subslice", "destroy"};
+  return NAMES[static_cast<size_t>(op)];
+}
+
+/**
+ * @class LatencyHistogram
+ * @brief A high dynamic range histogram of latencies, in nanoseconds.
+ *
+ * A `LatencyHistogram` covers every 64-bit value with a relative error below 1/64 (about two
+ * significant digits) in a fixed array of counters: values below 128 have a bucket each, and
+ * every further power of two is split into 64 linear sub-buckets. Recording is a couple of bit
+ * operations and a relaxed increment, so that it can stay on in production-like runs.
+ * A histogram has a single writer; other threads may read it concurrently, e.g. to merge it.
+ *
+ * @note For more information about HDR histograms, refer to
+ *       [HdrHistogram](https://hdrhistogram.github.io/HdrHistogram/).
+ */
+class LatencyHistogram {
+private:
+
+  static constexpr unsigned SUB_BITS = 7;                          ///< The bits of a sub-bucket.
+  static constexpr size_t HALF = size_t(1) << (SUB_BITS - 1);      ///< The sub-buckets per power.
+  static constexpr size_t BUCKETS = (64 - SUB_BITS) * HALF + 2 * HALF;
+
+  std::array<std::atomic<uint64_t>, BUCKETS> counts_; ///< The number of values in each bucket.
+
+  /*–
+   * AF: the multiset of recorded values, each one rounded to the range of its bucket.
+   *
+   * ---
+   *
+   * RI: - bucket i < 2 · HALF holds the value i
+   *     - bucket i ≥ 2 · HALF holds the values [lowest(i), highest(i)] of index(v) = i
+   */
+
+  /**
+   * @brief Returns the bucket of value `v`.
+   */
+  static constexpr size_t index(uint64_t v) noexcept {
+    if (v < 2 * HALF) return static_cast<size_t>(v);
+    const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - SUB_BITS;
+    return shift * HALF + static_cast<size_t>(v >> shift);
+  }
+
+  /**
+   * @brief Returns the highest value that falls in bucket `i`.
+   */
+  static constexpr uint64_t highest(size_t i) noexcept {
+    if (i < 2 * HALF) return i;
+    const size_t shift = i / HALF - 1;
+    const uint64_t lowest = static_cast<uint64_t>(i - shift * HALF) << shift;
+    return lowest + (uint64_t(1) << shift) - 1;
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  LatencyHistogram() noexcept : counts_() {}
+
+  /**
+   * @brief Copy constructor.
+   *
+   * Takes a snapshot of `o`, which may be concurrently recorded into.
+   */
+  LatencyHistogram(const LatencyHistogram & o) noexcept : counts_() { add(o); }
+
+  LatencyHistogram & operator=(const LatencyHistogram & o) noexcept {
+    if (this != &o) reset(), add(o);
+    return *this;
+  }
+
+  /**
+   * @brief Records a value.
+   *
+   * Only the owner of `this` may record into it.
+   *
+   * @param v The value to record.
+   */
+  void record(uint64_t v) noexcept {
+    auto & c = counts_[index(v)];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Adds the values recorded in `o` to `this`.
+   */
+  void add(const LatencyHistogram & o) noexcept {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      uint64_t n = o.counts_[i].load(std::memory_order_relaxed);
+      if (n) counts_[i].store(counts_[i].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Forgets every recorded value.
+   */
+  void reset() noexcept {
+    for (auto & c : counts_) c.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the number of recorded values.
+   */
+  uint64_t count() const noexcept {
+    uint64_t n = 0;
+    for (const auto & c : counts_) n += c.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  /**
+   * @brief Returns the value below which a given percentage of the recorded values fall.
+   *
+   * @param p The percentile, in [0, 100].
+   * @return The highest value equivalent to the percentile, or 0 if `this` is empty.
+   */
+  uint64_t percentile(double p) const noexcept {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p / 100 * static_cast<double>(total) + 0.5);
+    rank = rank < 1 ? 1 : rank > total ? total : rank;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+      if ((seen += counts_[i].load(std::memory_order_relaxed)) >= rank) return highest(i);
+    return highest(BUCKETS - 1);
+  }
+
+  /**
+   * @brief Returns the (bucket-rounded) maximum recorded value, or 0 if `this` is empty.
+   */
+  uint64_t max() const noexcept {
+    for (size_t i = BUCKETS; i > 0; --i)
+      if (counts_[i - 1].load(std::memory_order_relaxed)) return highest(i - 1);
+    return 0;
+  }
+};
+
+/**
+ * @class LatencyRecorder
+ * @brief The process-wide collection of per-thread `Slice` latency histograms.
+ *
+ * Every thread records into its own histograms, one per `SliceOp`, so that recording never
+ * contends. Snapshots merge the histograms of every thread that recorded, alive or not.
+ * The registry and the histograms are intentionally leaked, and each thread only keeps a
+ * trivially destructible pointer to its own, so that slices destroyed during static destruction
+ * (after the thread-local objects of the main thread) can still record their latency.
+ */
+class LatencyRecorder {
+private:
+
+  static constexpr size_t OPS = static_cast<size_t>(SliceOp::COUNT); ///< The recorded operations.
+
+  using Histograms = std::array<LatencyHistogram, OPS>;
+
+  /**
+   * @brief The registry of the histograms of every thread.
+   */
+  struct Registry {
+    std::mutex mutex{};                     ///< Guards `histograms`.
+    std::vector<Histograms *> histograms{}; ///< The histograms of every thread, alive or not.
+  };
+
+  static Registry & registry() {
+    static Registry * r = new Registry();
+    return *r;
+  }
+
+  static Histograms & local() {
+    thread_local Histograms * h = [] {
+      Histograms * hs = new Histograms();
+      std::lock_guard lock(registry().mutex);
+      registry().histograms.push_back(hs);
+      return hs;
+    }();
+    return *h;
+  }
+
+public:
+
+  /**
+   * @brief Records the latency of an operation performed by the calling thread.
+   *
+   * @param op The operation.
+   * @param ns The latency of the operation, in nanoseconds.
+   */
+  static void record(SliceOp op, uint64_t ns) { local()[static_cast<size_t>(op)].record(ns); }
+
+  /**
+   * @brief Returns the latencies of an operation recorded by every thread so far.
+   */
+  static LatencyHistogram snapshot(SliceOp op) {
+    std::lock_guard lock(registry().mutex);
+    LatencyHistogram h;
+    for (Histograms * l : registry().histograms) h.add((*l)[static_cast<size_t>(op)]);
+    return h;
+  }
+
+  /**
+   * @brief Forgets every recorded latency.
+   *
+   * Must not race with recording threads.
+   */
+  static void reset() {
+    std::lock_guard lock(registry().mutex);
+    for (Histograms * l : registry().histograms)
+      for (auto & h : *l) h.reset();
+  }
+
+  /**
+   * @brief Returns a table with the count and the latency percentiles of every operation.
+   */
+  static std::string report() {
+    std::string s = std::format("{:<10}{:>12}{:>10}{:>10}{:>10}{:>10}{:>10}{:>12}\n", "op", "count",
+     "p50", "p90", "p99", "p99.9", "p99.99", "max (ns)");
+    for (size_t i = 0; i < OPS; ++i) {
+      LatencyHistogram h = snapshot(static_cast<SliceOp>(i));
+      s += std::format("{:<10}{:>12}{:>10}{:>10}{:>10}{:>10}{:>10}{:>12}\n",
+       slice_op_name(static_cast<SliceOp>(i)), h.count(), h.percentile(50), h.percentile(90),
+       h.percentile(99), h.percentile(99.9), h.percentile(99.99), h.max());
+    }
+    return s;
+  }
+};
+
+/**
+ * @class LatencyScope
+ * @brief Records the time spent in a scope as the latency of a `Slice` operation.
+ */
+class LatencyScope {
+private:
+
+  SliceOp op_;                                  ///< The timed operation.
+  std::chrono::steady_clock::time_point start_; ///< The time the scope was entered.
+
+public:
+
+  explicit LatencyScope(SliceOp op) noexcept : op_(op), start_(std::chrono::steady_clock::now()) {}
+
+  LatencyScope(const LatencyScope &) = delete;
+  LatencyScope & operator=(const LatencyScope &) = delete;
+
+  ~LatencyScope() noexcept {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    try {
+      LatencyRecorder::record(op_, static_cast<uint64_t>(ns.count()));
+    } catch (...) {
+      // The first record of a thread allocates its histograms; if that fails, drop the sample.
+    }
+  }
+};
+
+#endif // LATENCY_HXX
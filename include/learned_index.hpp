@@ -0,0 +1,235 @@
+#ifndef LEARNED_INDEX_HXX
+#define LEARNED_INDEX_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @class LearnedIndex
+ * @brief A piecewise linear learned index over a sorted `Slice`.
+ *
+ * A `LearnedIndex` approximates the mapping from keys to positions of a sorted `Slice` with a
+ * sequence of linear segments, each one predicting the position of its keys within an error
+ * bound `eps`. A lookup finds the segment of the key, evaluates it, and counts the keys lower
+ * than the searched one in a window of about `2 · eps` positions around the prediction; that
+ * count is branchless and vectorized by the compiler. The index is built in a single streaming
+ * pass (a shrinking cone per segment) and stores only the segments, so its memory is
+ * O(segments) rather than O(n). The keys are not copied: the indexed `Slice` must outlive `this`.
+ *
+ * @note For more information about learned indexes, refer to
+ *       [The PGM-index](https://pgm.di.unipi.it/).
+ *
+ * @tparam T The type of the keys, which must be arithmetic.
+ */
+template<typename T>
+requires std::is_arithmetic_v<T>
+class LearnedIndex {
+private:
+
+  static constexpr uint64_t MAGIC = 0x58444e494d4750; ///< "PGMINDX", the serialization tag.
+  static constexpr uint32_t VERSION = 1;              ///< The serialization format version.
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  const T * keys_;      ///< The indexed keys, owned by a `Slice` that outlives `this`.
+  size_t len_;          ///< The number of indexed keys.
+  size_t eps_;          ///< The maximum error of the prediction of every segment.
+  Slice<T> first_;      ///< The first key of each segment.
+  Slice<double> slope_; ///< The slope of each segment.
+  Slice<size_t> pos_;   ///< The position of the first key of each segment.
+
+  /*–
+   * AF: a model of the sorted keys [keys_[0], …, keys_[len_ - 1]] made of the segments
+   *     i = 0, …, first_.size() - 1, predicting for a key x ∈ [first_[i], first_[i + 1]) the
+   *     position pos_[i] + slope_[i] · (x - first_[i]).
+   *
+   * ---
+   *
+   * RI: - first_, slope_ and pos_ have the same size, which is 0 ⇔ len_ = 0
+   *     - first_ is strictly increasing, pos_ is strictly increasing and pos_[0] = 0
+   *     - for every distinct key k, its prediction is at most eps_ away from its first position
+   */
+
+  /**
+   * @brief Predicts the position of `x` with segment `i`, clamped to the positions it spans.
+   */
+  size_t predict(size_t i, T x) const noexcept {
+    const size_t lo = pos_.data()[i];
+    const size_t hi = i + 1 < pos_.size() ? pos_.data()[i + 1] : len_;
+    double p = static_cast<double>(lo)
+             + slope_.data()[i] * (static_cast<double>(x) - static_cast<double>(first_.data()[i]));
+    if (!(p > static_cast<double>(lo))) return lo;
+    return p < static_cast<double>(hi) ? static_cast<size_t>(p) : hi;
+  }
+
+  /**
+   * @brief Closes the segment starting at `(k, p)` and opens a new one.
+   */
+  void push_segment(T k, size_t p, double lo, double hi) {
+    first_.append(k);
+    slope_.append(hi == INF ? lo : (lo + hi) / 2);
+    pos_.append(p);
+  }
+
+public:
+
+  /**
+   * @brief Slice constructor.
+   *
+   * Creates `this` indexing the keys of a sorted `Slice` in one pass over them.
+   *
+   * @param s The sorted `Slice` to index, which must outlive `this`.
+   * @param eps The maximum error of the predicted positions.
+   *
+   * @throws invalid_argument if `s` is not sorted in non-decreasing order.
+   * @throws Any exception that may be thrown during the allocation.
+   */
+  explicit LearnedIndex(const Slice<T> & s, size_t eps = 64)
+      : keys_(s.data()), len_(s.size()), eps_(eps), first_(), slope_(), pos_() {
+    if (len_ == 0) return;
+    T k0 = keys_[0];
+    size_t p0 = 0;
+    double lo = 0, hi = INF;
+    for (size_t p = 1; p < len_; ++p) {
+      const T k = keys_[p];
+      if (k < keys_[p - 1]) throw std::invalid_argument("Slice is not sorted.");
+      if (k == keys_[p - 1]) continue;
+      const double dx = static_cast<double>(k) - static_cast<double>(k0);
+      const double dp = static_cast<double>(p) - static_cast<double>(p0);
+      const double klo = (dp - static_cast<double>(eps_)) / dx;
+      const double khi = (dp + static_cast<double>(eps_)) / dx;
+      if (klo > hi || khi < lo) {
+        push_segment(k0, p0, lo, hi);
+        k0 = k, p0 = p, lo = 0, hi = INF;
+      } else {
+        lo = std::max(lo, klo), hi = std::min(hi, khi);
+      }
+    }
+    push_segment(k0, p0, lo, hi);
+  }
+
+  LearnedIndex(const LearnedIndex &) = delete;
+  LearnedIndex & operator=(const LearnedIndex &) = delete;
+
+  LearnedIndex(LearnedIndex && o) noexcept = default;
+  LearnedIndex & operator=(LearnedIndex && o) noexcept = default;
+
+  /**
+   * @brief Returns the number of keys indexed by `this`.
+   */
+  size_t size() const noexcept { return len_; }
+
+  /**
+   * @brief Returns the number of linear segments of `this`.
+   */
+  size_t segments() const noexcept { return first_.size(); }
+
+  /**
+   * @brief Returns the error bound of `this`.
+   */
+  size_t epsilon() const noexcept { return eps_; }
+
+  /**
+   * @brief Finds the first key that is not lower than `x`.
+   *
+   * The answer lies in the window around the prediction whenever the keys around `x` are
+   * distinct; long runs of duplicates may push it outside, in which case the search continues
+   * exponentially from the edge of the window.
+   *
+   * @param x The key to search for.
+   * @return The position of the first key not lower than `x`, or `size()` if there is none.
+   */
+  size_t lower_bound(T x) const noexcept {
+    if (len_ == 0 || !(keys_[0] < x)) return 0;
+    const T * seg = std::upper_bound(first_.begin(), first_.end(), x);
+    const size_t p = predict(static_cast<size_t>(seg - first_.begin()) - 1, x);
+    const size_t lo = p > eps_ + 1 ? p - eps_ - 1 : 0;
+    const size_t hi = std::min(len_, p + eps_ + 2);
+
+    size_t r = lo;
+    for (size_t i = lo; i < hi; ++i) r += keys_[i] < x;
+
+    if (r == hi && hi < len_ && keys_[hi] < x) {
+      size_t step = 1, b = hi;
+      while (b < len_ && keys_[b] < x) r = b + 1, b += step, step *= 2;
+      return static_cast<size_t>(std::lower_bound(keys_ + r, keys_ + std::min(b, len_), x) - keys_);
+    }
+    if (r == lo && lo > 0 && !(keys_[lo - 1] < x)) {
+      size_t step = 1, a = lo - 1;
+      while (a > 0 && !(keys_[a] < x)) r = a, a = a > step ? a - step : 0, step *= 2;
+      return static_cast<size_t>(std::lower_bound(keys_ + a, keys_ + r, x) - keys_);
+    }
+    return r;
+  }
+
+  /**
+   * @brief Writes `this` to a binary stream, to be stored next to the indexed `Slice`.
+   *
+   * @param os The stream to write to.
+   *
+   * @throws runtime_error if the stream fails.
+   */
+  void save(std::ostream & os) const {
+    const uint64_t header[] = {MAGIC, VERSION, sizeof(T), len_, eps_, first_.size()};
+    os.write(reinterpret_cast<const char *>(header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(first_.data()), first_.size() * sizeof(T));
+    os.write(reinterpret_cast<const char *>(slope_.data()), slope_.size() * sizeof(double));
+    os.write(reinterpret_cast<const char *>(pos_.data()), pos_.size() * sizeof(size_t));
+    if (!os) throw std::runtime_error("Failed to write LearnedIndex.");
+  }
+
+  /**
+   * @brief Reads an index written by `save()` and attaches it to the `Slice` it was built on.
+   *
+   * @param is The stream to read from.
+   * @param s The indexed `Slice`, which must outlive the result.
+   * @return The loaded index.
+   *
+   * @throws runtime_error if the stream fails or does not hold a valid index of `s`.
+   */
+  static LearnedIndex load(std::istream & is, const Slice<T> & s) {
+    uint64_t header[6];
+    is.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!is || header[0] != MAGIC || header[1] != VERSION || header[2] != sizeof(T))
+      throw std::runtime_error("Stream does not hold a LearnedIndex.");
+    if (header[3] != s.size()) throw std::runtime_error("LearnedIndex does not match the Slice.");
+
+    LearnedIndex idx(Slice<T>(), header[4]);
+    idx.keys_ = s.data(), idx.len_ = s.size();
+    const size_t n = header[5];
+    if (n > idx.len_ || (n == 0) != (idx.len_ == 0)) throw std::runtime_error("Corrupt LearnedIndex.");
+    idx.first_ = Slice<T>(n), idx.slope_ = Slice<double>(n), idx.pos_ = Slice<size_t>(n);
+    for (size_t i = 0; i < n && is; ++i) {
+      T k;
+      is.read(reinterpret_cast<char *>(&k), sizeof(T));
+      idx.first_.append(k);
+    }
+    for (size_t i = 0; i < n && is; ++i) {
+      double m;
+      is.read(reinterpret_cast<char *>(&m), sizeof(double));
+      idx.slope_.append(m);
+    }
+    for (size_t i = 0; i < n && is; ++i) {
+      size_t p;
+      is.read(reinterpret_cast<char *>(&p), sizeof(size_t));
+      idx.pos_.append(p);
+    }
+    if (!is) throw std::runtime_error("Truncated LearnedIndex.");
+    const size_t * pos = idx.pos_.data();
+    const T * first = idx.first_.data();
+    for (size_t i = 0; i < n; ++i) {
+      if ((i == 0 ? pos[i] != 0 : pos[i] <= pos[i - 1]) || pos[i] >= idx.len_ || !(first[i] == idx.keys_[pos[i]])
+          || (i > 0 && !(first[i - 1] < first[i])))
+        throw std::runtime_error("Corrupt LearnedIndex.");
+    }
+    return idx;
+  }
+};
+
+#endif // LEARNED_INDEX_HXX
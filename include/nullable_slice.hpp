@@ -0,0 +1,320 @@
+#ifndef NULLABLE_SLICE_HXX
+#define NULLABLE_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @class NullableSlice
+ * @brief A `Slice` of values that may be null, with a packed validity bitmap.
+ *
+ * A `NullableSlice` stores its values contiguously in one `Slice<T>` (null values hold `T()`)
+ * and whether each one is valid in a bitmap of one bit per value, least significant bit first
+ * (the layout of Arrow's validity buffers), instead of a `Slice<std::optional<T>>` that doubles
+ * the size of the elements and interleaves flags with values. The bitmap is only materialized
+ * when the first null is appended, so fully valid columns carry no overhead.
+ *
+ * The aggregation kernels process the values 64 at a time, one bitmap word per block: fully
+ * valid blocks run the plain (vectorized) loop, fully null blocks are skipped, and mixed blocks
+ * combine the mask with the values without branches (with AVX2 for `double`, where available).
+ *
+ * @tparam T The type of the values.
+ */
+template<typename T>
+requires std::default_initializable<T>
+class NullableSlice {
+private:
+
+  Slice<T> values_;          ///< The values, `T()` where null.
+  Slice<uint64_t> validity_; ///< The validity bitmap; empty while every value is valid.
+  size_t nulls_;             ///< The number of null values.
+
+  /*–
+   * AF: the sequence [v_0, …, v_{values_.size() - 1}] with v_i = values_[i] if bit i of
+   *     validity_ is set (or validity_ is empty), and v_i = null otherwise.
+   *
+   * ---
+   *
+   * RI: - validity_.size() = 0 ⇒ nulls_ = 0
+   *     - validity_.size() > 0 ⇒ validity_.size() = ⌈values_.size() / 64⌉, and the bits past
+   *       values_.size() are 0
+   *     - nulls_ = the number of values whose bit is 0
+   */
+
+  static constexpr size_t words(size_t n) noexcept { return (n + 63) / 64; }
+
+  /**
+   * @brief Materializes the bitmap, with every current value valid.
+   */
+  void materialize() {
+    const size_t n = values_.size();
+    Slice<uint64_t> bits(words(n + 1));
+    for (size_t w = 0; w < n / 64; ++w) bits.append(~uint64_t(0));
+    if (n % 64) bits.append((uint64_t(1) << (n % 64)) - 1);
+    validity_ = std::move(bits);
+  }
+
+  /**
+   * @brief Sets the validity of the value just appended at position `i`.
+   */
+  void mark(size_t i, bool valid) {
+    if (i % 64 == 0) validity_.append(uint64_t(0));
+    if (valid) validity_.data()[i / 64] |= uint64_t(1) << (i % 64);
+    else ++nulls_;
+  }
+
+  /**
+   * @brief Returns the validity word of block `w`, which may be the partial last one.
+   */
+  uint64_t word(size_t w) const noexcept {
+    if (validity_.size() > 0) return validity_.data()[w];
+    const size_t rest = values_.size() - 64 * w;
+    return rest >= 64 ? ~uint64_t(0) : (uint64_t(1) << rest) - 1;
+  }
+
+  /**
+   * @brief Returns `x` if `bit` is 1 and `other` if it is 0, without branches.
+   */
+  static T select(uint64_t bit, T x, T other) noexcept requires std::is_arithmetic_v<T> {
+    using U = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t,
+     std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+    const U mask = static_cast<U>(U(0) - static_cast<U>(bit));
+    return std::bit_cast<T>(static_cast<U>((std::bit_cast<U>(x) & mask) | (std::bit_cast<U>(other) & ~mask)));
+  }
+
+  /**
+   * @brief Calls `full(first, count)` on every fully valid block and `mixed(first, count, word)`
+   *        on every partially valid one.
+   */
+  void blocks(auto && full, auto && mixed) const {
+    const size_t n = values_.size();
+    if (nulls_ == 0) return full(size_t(0), n);
+    for (size_t w = 0; w < words(n); ++w) {
+      const uint64_t m = word(w);
+      const size_t first = 64 * w, count = n - first < 64 ? n - first : 64;
+      if (m == 0) continue;
+      if (count == 64 && m == ~uint64_t(0)) full(first, count);
+      else mixed(first, count, m);
+    }
+  }
+
+public:
+
+  /// The type of the sums of the values.
+  using sum_type = std::conditional_t<std::is_floating_point_v<T>, T,
+   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  NullableSlice() : values_(), validity_(), nulls_(0) {}
+
+  /**
+   * @brief Values constructor.
+   *
+   * Creates `this` from values that are all valid, without a bitmap.
+   */
+  explicit NullableSlice(Slice<T> && values) : values_(std::move(values)), validity_(), nulls_(0) {}
+
+  /**
+   * @brief Values and validity constructor.
+   *
+   * Creates `this` from values and a validity bitmap of ⌈n / 64⌉ words, e.g. as produced by
+   * another library. The bits past the last value are cleared.
+   *
+   * @throws std::invalid_argument If the bitmap does not have as many words as needed.
+   */
+  NullableSlice(Slice<T> && values, Slice<uint64_t> && validity)
+      : values_(std::move(values)), validity_(std::move(validity)), nulls_(0) {
+    if (validity_.size() != words(values_.size())) throw std::invalid_argument("Validity bitmap of the wrong size.");
+    const size_t n = values_.size();
+    if (n % 64 && validity_.data()[n / 64] >> (n % 64)) {
+      validity_.reserve(validity_.size() + 1);  // own the bitmap before clearing its padding
+      validity_.data()[n / 64] &= (uint64_t(1) << (n % 64)) - 1;
+    }
+    size_t valid = 0;
+    for (uint64_t w : validity_) valid += static_cast<size_t>(std::popcount(w));
+    nulls_ = n - valid;
+    if (nulls_ == 0) validity_ = Slice<uint64_t>();
+  }
+
+  /**
+   * @brief Iterable constructor.
+   *
+   * Creates `this` from a collection of `std::optional<T>`.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  explicit NullableSlice(auto && c) requires Iterable<std::optional<T>, decltype(c)> : NullableSlice() {
+    for (auto && v : c) {
+      if (v) append(*v);
+      else append_null();
+    }
+  }
+
+  /**
+   * @brief Returns the number of values in `this`, null or not.
+   */
+  size_t size() const noexcept { return values_.size(); }
+
+  /**
+   * @brief Returns the number of null values in `this`.
+   */
+  size_t null_count() const noexcept { return nulls_; }
+
+  /**
+   * @brief Returns the values of `this`, with `T()` in place of nulls.
+   */
+  const Slice<T> & values() const noexcept { return values_; }
+
+  /**
+   * @brief Returns the validity bitmap of `this`, which is empty when every value is valid.
+   */
+  const Slice<uint64_t> & validity() const noexcept { return validity_; }
+
+  /**
+   * @brief Checks whether the value at position `i` is valid (not null).
+   */
+  bool is_valid(size_t i) const noexcept {
+    return validity_.size() == 0 || (validity_.data()[i / 64] >> (i % 64) & 1);
+  }
+
+  /**
+   * @brief Returns the value at position `i`.
+   *
+   * @return A pointer to the value, or `nullptr` if it is null.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  const T * operator[](size_t i) const {
+    if (i >= size()) throw std::out_of_range("Invalid argument");
+    return is_valid(i) ? values_.data() + i : nullptr;
+  }
+
+  /**
+   * @brief Appends a valid value to `this`.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(auto && v) requires std::constructible_from<T, decltype(v)> {
+    values_.append(std::forward<decltype(v)>(v));
+    if (validity_.size() > 0) mark(values_.size() - 1, true);
+  }
+
+  /**
+   * @brief Appends a null value to `this`, materializing the bitmap on the first one.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append_null() {
+    if (validity_.size() == 0) materialize();
+    values_.append(T());
+    mark(values_.size() - 1, false);
+  }
+
+  /**
+   * @brief Returns the number of valid values, counted from the bitmap.
+   */
+  size_t count() const noexcept {
+    if (validity_.size() == 0) return values_.size();
+    size_t n = 0;
+    for (uint64_t w : validity_) n += static_cast<size_t>(std::popcount(w));
+    return n;
+  }
+
+  /**
+   * @brief Returns the sum of the valid values, or 0 if there is none.
+   */
+  sum_type sum() const noexcept requires std::is_arithmetic_v<T> {
+    const T * v = values_.data();
+    sum_type s = 0;
+    blocks([&](size_t first, size_t count) {
+      for (size_t i = first; i < first + count; ++i) s += v[i];
+    }, [&](size_t first, size_t count, uint64_t m) {
+#if defined(__AVX2__)
+      if constexpr (std::is_same_v<T, double>) {
+        const __m256i bit = _mm256_set_epi64x(8, 4, 2, 1);
+        __m256d acc = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+          const __m256i b = _mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>(m >> i)), bit);
+          const __m256d mask = _mm256_castsi256_pd(_mm256_cmpeq_epi64(b, bit));
+          acc = _mm256_add_pd(acc, _mm256_and_pd(mask, _mm256_loadu_pd(v + first + i)));
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc);
+        s += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; i < count; ++i) s += (m >> i & 1) ? v[first + i] : 0.0;
+        return;
+      }
+#endif
+      sum_type acc[4] = {};  // independent partial sums, to overlap the additions
+      for (size_t i = 0; i < count; ++i) acc[i % 4] += select(m >> i & 1, v[first + i], T(0));
+      s += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    });
+    return s;
+  }
+
+  /**
+   * @brief Returns the least valid value, or nothing if there is none.
+   *
+   * NaNs are ignored, unless every valid value is NaN.
+   */
+  std::optional<T> min() const noexcept requires std::is_arithmetic_v<T> {
+    if (count() == 0) return std::nullopt;
+    constexpr T TOP = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    const T * v = values_.data();
+    T lo = TOP;
+    blocks([&](size_t first, size_t count) {
+      for (size_t i = first; i < first + count; ++i) lo = v[i] < lo ? v[i] : lo;
+    }, [&](size_t first, size_t count, uint64_t m) {
+#if defined(__AVX2__)
+      if constexpr (std::is_same_v<T, double>) {
+        const __m256i bit = _mm256_set_epi64x(8, 4, 2, 1);
+        __m256d acc = _mm256_set1_pd(TOP);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+          const __m256i b = _mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>(m >> i)), bit);
+          const __m256d mask = _mm256_castsi256_pd(_mm256_cmpeq_epi64(b, bit));
+          acc = _mm256_min_pd(_mm256_blendv_pd(acc, _mm256_loadu_pd(v + first + i), mask), acc);
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc);
+        for (double l : lanes) lo = l < lo ? l : lo;
+        for (; i < count; ++i) lo = (m >> i & 1) && v[first + i] < lo ? v[first + i] : lo;
+        return;
+      }
+#endif
+      T acc[4] = {TOP, TOP, TOP, TOP};
+      for (size_t i = 0; i < count; ++i) {
+        T & a = acc[i % 4];
+        const T x = select(m >> i & 1, v[first + i], TOP);
+        a = x < a ? x : a;
+      }
+      for (T a : acc) lo = a < lo ? a : lo;
+    });
+    if constexpr (std::numeric_limits<T>::has_quiet_NaN)
+      if (lo == TOP) {  // only infinities, or only NaNs
+        for (size_t i = 0; i < size(); ++i)
+          if (is_valid(i) && v[i] == v[i]) return v[i];
+        return std::numeric_limits<T>::quiet_NaN();
+      }
+    return lo;
+  }
+};
+
+#endif // NULLABLE_SLICE_HXX
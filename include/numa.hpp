@@ -0,0 +1,279 @@
+#ifndef NUMA_HXX
+#define NUMA_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Where the pages of a `Slice` are placed on a NUMA machine.
+ */
+enum class NumaPolicy : uint8_t {
+  Default,    ///< The policy of the allocating thread, usually the node of the first toucher.
+  Interleave, ///< Round-robin over every node, page by page.
+  Bind,       ///< On a single node.
+  FirstTouch  ///< Each partition on the node of the worker that constructs it.
+};
+
+/**
+ * @class Numa
+ * @brief NUMA topology and placement of `Slice` storage.
+ *
+ * On a multi-socket machine, a page lives on the node of the thread that first touches it, so
+ * a large `Slice` constructed by one thread ends up on a single node, and its parallel consumers
+ * on the other nodes pay for remote accesses. `Numa` applies a placement policy to the storage
+ * of a `Slice` (`mbind`), or to the future allocations of a thread (`set_mempolicy`), and
+ * `build()` constructs a `Slice` from one worker per partition, each pinned to the node that
+ * should own its partition.
+ *
+ * The kernel interface is called directly, so that libnuma is not needed. On a single-node or
+ * non-Linux machine, placement is a no-op and `build()` only constructs in parallel.
+ *
+ * @note For more information about NUMA memory policies, refer to
+ *       [set_mempolicy(2)](https://man7.org/linux/man-pages/man2/set_mempolicy.2.html).
+ */
+class Numa {
+private:
+
+  static constexpr int MPOL_DEFAULT_ = 0;           ///< `MPOL_DEFAULT`, from <numaif.h>.
+  static constexpr int MPOL_BIND_ = 2;              ///< `MPOL_BIND`.
+  static constexpr int MPOL_INTERLEAVE_ = 3;        ///< `MPOL_INTERLEAVE`.
+  static constexpr unsigned MPOL_MF_MOVE_ = 1 << 1; ///< `MPOL_MF_MOVE`, to migrate touched pages.
+  static constexpr unsigned long MPOL_F_NODE_ = 1;  ///< `MPOL_F_NODE`.
+  static constexpr unsigned long MPOL_F_ADDR_ = 2;  ///< `MPOL_F_ADDR`.
+  static constexpr size_t MAX_NODES = 64;           ///< The nodes a one-word mask can address.
+  static constexpr size_t GRAIN = size_t(1) << 16;  ///< The fewest elements worth a worker.
+
+  /**
+   * @brief Parses a sysfs list such as "0-3,8,10-11".
+   */
+  static std::vector<size_t> parse_list(const std::string & s) {
+    std::vector<size_t> ids;
+    size_t i = 0;
+    while (i < s.size()) {
+      size_t lo = 0, hi;
+      while (i < s.size() && s[i] >= '0' && s[i] <= '9') lo = 10 * lo + size_t(s[i++] - '0');
+      hi = lo;
+      if (i < s.size() && s[i] == '-')
+        for (hi = 0, ++i; i < s.size() && s[i] >= '0' && s[i] <= '9';) hi = 10 * hi + size_t(s[i++] - '0');
+      for (size_t id = lo; id <= hi; ++id) ids.push_back(id);
+      while (i < s.size() && (s[i] < '0' || s[i] > '9')) ++i;
+    }
+    return ids;
+  }
+
+  /**
+   * @brief Reads a sysfs list, or returns an empty one if it cannot be read.
+   */
+  static std::vector<size_t> read_list(const std::string & path) {
+    std::ifstream in(path);
+    std::string s;
+    if (!in || !std::getline(in, s)) return {};
+    return parse_list(s);
+  }
+
+  /**
+   * @brief Returns the online nodes, read once.
+   */
+  static const std::vector<size_t> & online() {
+#if defined(__linux__)
+    static const std::vector<size_t> ids = [] {
+      std::vector<size_t> v = read_list("/sys/devices/system/node/online");
+      std::erase_if(v, [](size_t id) { return id >= MAX_NODES; });
+      return v.empty() ? std::vector<size_t>{0} : v;
+    }();
+#else
+    static const std::vector<size_t> ids{0};
+#endif
+    return ids;
+  }
+
+  /**
+   * @brief Returns the mask of the nodes `policy` spreads over, or 0 if it needs none.
+   */
+  static unsigned long mask(NumaPolicy policy, size_t node) noexcept {
+    unsigned long m = 0;
+    if (policy == NumaPolicy::Interleave) for (size_t id : online()) m |= 1ul << id;
+    else if (policy == NumaPolicy::Bind) m = 1ul << online()[node % online().size()];
+    return m;
+  }
+
+  static int mode(NumaPolicy policy) noexcept {
+    return policy == NumaPolicy::Interleave ? MPOL_INTERLEAVE_ : policy == NumaPolicy::Bind ? MPOL_BIND_ : MPOL_DEFAULT_;
+  }
+
+public:
+
+  /**
+   * @brief Returns the number of online nodes, 1 on a non-NUMA or non-Linux machine.
+   */
+  static size_t nodes() { return online().size(); }
+
+  /**
+   * @brief Returns the CPUs of the `node`-th online node.
+   */
+  static std::vector<size_t> cpus(size_t node) {
+    return read_list("/sys/devices/system/node/node" + std::to_string(online()[node % nodes()]) + "/cpulist");
+  }
+
+  /**
+   * @brief Pins the calling thread to the CPUs of the `node`-th online node.
+   *
+   * @return Whether the thread was pinned; it is not on a single-node machine.
+   */
+  static bool run_on(size_t node) {
+#if defined(__linux__)
+    if (nodes() < 2) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t cpu : cpus(node)) if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void) node;
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Places the pages of `[p, p + bytes)` according to `policy`.
+   *
+   * Only the pages entirely inside the range are placed, and the ones already touched are
+   * migrated. `FirstTouch` leaves the placement to whoever touches the pages first.
+   *
+   * @param p The start of the range.
+   * @param bytes The size of the range.
+   * @param policy The placement.
+   * @param node The node to bind to, as an index among the online nodes.
+   * @return Whether a policy was applied; it is not on a single-node machine.
+   */
+  static bool place(const void * p, size_t bytes, NumaPolicy policy, size_t node = 0) {
+#if defined(__linux__)
+    if (nodes() < 2 || policy == NumaPolicy::FirstTouch) return false;
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t lo = (reinterpret_cast<uintptr_t>(p) + page - 1) & ~(page - 1);
+    const uintptr_t hi = (reinterpret_cast<uintptr_t>(p) + bytes) & ~(page - 1);
+    if (hi <= lo) return false;
+    const unsigned long m = mask(policy, node);
+    return syscall(SYS_mbind, lo, hi - lo, mode(policy), m ? &m : nullptr, m ? MAX_NODES + 1 : 0, MPOL_MF_MOVE_) == 0;
+#else
+    (void) p, (void) bytes, (void) policy, (void) node;
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Places the storage of `s` according to `policy`.
+   *
+   * Best called right after the size constructor, before the storage is touched.
+   */
+  template<typename T>
+  static bool place(const Slice<T> & s, NumaPolicy policy, size_t node = 0) {
+    return place(s.data(), s.capacity() * sizeof(T), policy, node);
+  }
+
+  /**
+   * @brief Applies `policy` to the future allocations of the calling thread.
+   *
+   * @return Whether the policy was applied; it is not on a single-node machine.
+   */
+  static bool set_thread_policy(NumaPolicy policy, size_t node = 0) {
+#if defined(__linux__)
+    if (nodes() < 2) return false;
+    const unsigned long m = mask(policy, node);
+    return syscall(SYS_set_mempolicy, mode(policy), m ? &m : nullptr, m ? MAX_NODES + 1 : 0) == 0;
+#else
+    (void) policy, (void) node;
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Returns the online node holding the page of `p`, or -1 if it is unknown.
+   */
+  static int node_of(const void * p) {
+#if defined(__linux__)
+    int id = -1;
+    if (syscall(SYS_get_mempolicy, &id, nullptr, 0, p, MPOL_F_NODE_ | MPOL_F_ADDR_) != 0) return -1;
+    return id;
+#else
+    (void) p;
+    return -1;
+#endif
+  }
+
+  /**
+   * @brief Creates a `Slice` of `n` elements placed according to `policy`.
+   *
+   * The storage is placed before it is touched, then the elements are constructed by one worker
+   * per partition: with `FirstTouch`, worker `w` of `W` is pinned to node `w * nodes() / W`, so
+   * that each node owns a contiguous share of the slice, in the order its consumers would take.
+   * If an element throws, the partitions already constructed are destroyed, and the first
+   * exception is propagated.
+   *
+   * @param n The number of elements.
+   * @param policy The placement.
+   * @param make The callable returning the element at each position, called concurrently.
+   * @param node The node to bind to, with `Bind`.
+   * @param workers The number of workers, or 0 for one per hardware thread.
+   * @return The slice.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<typename T>
+  static Slice<T> build(size_t n, NumaPolicy policy, auto && make, size_t node = 0, size_t workers = 0)
+      requires std::constructible_from<T, std::invoke_result_t<decltype(make) &, size_t>> {
+    Slice<T> s(n);
+    place(s, policy, node);
+    if (workers == 0) workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, n / GRAIN));
+    const bool pin = policy == NumaPolicy::FirstTouch && nodes() > 1;
+
+    s.append_with(n, [&](T * dst, size_t count) {
+      std::vector<std::exception_ptr> errors(workers);
+      auto part = [&](size_t w) {
+        const size_t lo = count * w / workers, hi = count * (w + 1) / workers;
+        if (pin) run_on(w * nodes() / workers);
+        size_t i = lo;
+        try {
+          for (; i < hi; ++i) new (dst + i) T(make(i));
+        } catch (...) {
+          if constexpr (!Destructible<T>) for (size_t j = lo; j < i; ++j) dst[j].~T();
+          errors[w] = std::current_exception();
+        }
+      };
+      {
+        std::vector<std::jthread> threads;
+        threads.reserve(workers - 1);
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(part, w);
+        if (pin) {
+          std::jthread t(part, 0);  // keep the calling thread unpinned
+        } else part(0);
+      }
+
+      const auto failed = std::find_if(errors.begin(), errors.end(), [](const auto & e) { return bool(e); });
+      if (failed == errors.end()) return;
+      if constexpr (!Destructible<T>)
+        for (size_t w = 0; w < workers; ++w)
+          if (!errors[w]) for (size_t i = count * w / workers; i < count * (w + 1) / workers; ++i) dst[i].~T();
+      std::rethrow_exception(*failed);
+    });
+    return s;
+  }
+};
+
+#endif // NUMA_HXX
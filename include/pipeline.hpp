@@ -0,0 +1,302 @@
+#ifndef PIPELINE_HXX
+#define PIPELINE_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The bytes of input each morsel of a `Pipeline` holds by default.
+ *
+ * Small enough that a morsel and its intermediates stay in a core's L2 cache.
+ */
+#ifndef SLICE_MORSEL_BYTES
+#define SLICE_MORSEL_BYTES (size_t(128) << 10)
+#endif
+
+/**
+ * @brief A stage of a `Pipeline`, appending the `Out` elements it makes of a morsel.
+ */
+template<typename Out, typename F>
+struct PipelineStage {
+  using type = Out;
+  F f; ///< Called as `f(const Slice<In> & in, Slice<Out> & out)`.
+};
+
+/**
+ * @class Pipeline
+ * @brief A chain of transforms over a `Slice`, run morsel by morsel.
+ *
+ * Running the stages of a transform one after the other over whole slices streams the data
+ * through memory once per stage. A `Pipeline` instead cuts its input into morsels small enough
+ * to stay cached, and runs every stage over a morsel before moving to the next one, so that
+ * only the input is read from, and the output written to, memory. The intermediates of a morsel
+ * live in per-thread scratch slices that are reused from one morsel to the next.
+ *
+ * With several workers, morsels are handed out dynamically (morsel-driven scheduling), so that
+ * uneven stages balance themselves.
+ *
+ * Pipelines are built with `Pipeline<In>()` and the `then()`, `map()` and `filter()` adaptors,
+ * each of which returns a new pipeline:
+ *
+ *     auto p = Pipeline<double>().map([](double x) { return x * x; }).filter([](double x) { return x > 1; });
+ *     p.run(src, out);
+ *
+ * @tparam In The type of the input elements.
+ * @tparam Stages The stages, as `PipelineStage`s.
+ */
+template<typename In, typename... Stages>
+class Pipeline {
+private:
+
+  template<typename, typename...> friend class Pipeline;
+
+  std::tuple<Stages...> stages_; ///< The stages, in order.
+  size_t morsel_;                ///< The number of input elements per morsel.
+
+  /*–
+   * AF: the composition of `stages_`, applied `morsel_` input elements at a time.
+   *
+   * ---
+   *
+   * RI: - morsel_ > 0
+   */
+
+  static constexpr size_t N = sizeof...(Stages); ///< The number of stages.
+
+  template<size_t I>
+  using stage_out = typename std::tuple_element_t<I, std::tuple<Stages...>>::type;
+
+public:
+
+  /// The type of the output elements.
+  using value_type = typename std::tuple_element_t<N, std::tuple<std::type_identity<In>, Stages...>>::type;
+
+private:
+
+  Pipeline(std::tuple<Stages...> && stages, size_t morsel) : stages_(std::move(stages)), morsel_(morsel) {}
+
+  /**
+   * @brief Returns the scratch slice of the calling thread for the output of stage `I`.
+   */
+  template<size_t I>
+  static Slice<stage_out<I>> & scratch() {
+    thread_local Slice<stage_out<I>> s;
+    return s;
+  }
+
+  /**
+   * @brief Runs the stages from `I` over `in`, appending the output of the last one to `out`.
+   */
+  template<size_t I, typename X>
+  void step(const Slice<X> & in, Slice<value_type> & out) const {
+    if constexpr (I + 1 == N) std::get<I>(stages_).f(in, out);
+    else {
+      Slice<stage_out<I>> & tmp = scratch<I>();
+      tmp.truncate(0);
+      std::get<I>(stages_).f(in, tmp);
+      step<I + 1>(tmp, out);
+    }
+  }
+
+  /**
+   * @brief Runs every stage over the `k`-th morsel of `src`, appending the output to `out`.
+   */
+  void morsel(const Slice<In> & src, size_t k, Slice<value_type> & out) const {
+    const size_t first = k * morsel_, len = std::min(morsel_, src.size() - first);
+    const Slice<In> in(const_cast<In *>(src.data()) + first, len);
+    if constexpr (N == 0) out.append(in.data(), len);
+    else step<0>(in, out);
+  }
+
+  /**
+   * @brief Calls `work(k)` for every morsel `k` of `n` elements, from `workers` threads.
+   *
+   * Morsels are claimed from a shared counter. After an exception, the morsels not yet claimed
+   * are skipped, and the first exception is propagated once every thread is done.
+   */
+  void schedule(size_t n, size_t workers, auto && work) const {
+    const size_t morsels = (n + morsel_ - 1) / morsel_;
+    if (workers == 0) workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    workers = std::min(workers, morsels);
+    if (workers <= 1) {
+      for (size_t k = 0; k < morsels; ++k) work(k);
+      return;
+    }
+    std::atomic<size_t> next = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    auto loop = [&] {
+      try {
+        for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < morsels;) work(k);
+      } catch (...) {
+        next.store(morsels, std::memory_order_relaxed);
+        std::lock_guard lock(mutex);
+        if (!error) error = std::current_exception();
+      }
+    };
+    {
+      std::vector<std::jthread> threads;
+      threads.reserve(workers - 1);
+      for (size_t w = 1; w < workers; ++w) threads.emplace_back(loop);
+      loop();
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`, which copies its input.
+   */
+  Pipeline() requires (N == 0) : stages_(), morsel_(std::max<size_t>(1, SLICE_MORSEL_BYTES / sizeof(In))) {}
+
+  /**
+   * @brief Returns the number of input elements per morsel.
+   */
+  size_t morsel() const noexcept { return morsel_; }
+
+  /**
+   * @brief Sets the number of input elements per morsel.
+   *
+   * @throws std::invalid_argument If `n` is 0.
+   */
+  Pipeline & morsel(size_t n) & {
+    if (n == 0) throw std::invalid_argument("Morsels cannot be empty.");
+    morsel_ = n;
+    return *this;
+  }
+
+  Pipeline && morsel(size_t n) && { return std::move(morsel(n)); }
+
+  /**
+   * @brief Appends a stage, called with each morsel of the current output and a `Slice<Out>` to
+   *        append its output to.
+   *
+   * @tparam Out The type of the output elements of the stage.
+   * @param f The stage, callable concurrently from several threads.
+   * @return The pipeline with the stage appended.
+   */
+  template<typename Out, typename F>
+  requires std::invocable<const F &, const Slice<value_type> &, Slice<Out> &>
+  auto then(F f) const & {
+    using S = PipelineStage<Out, F>;
+    return Pipeline<In, Stages..., S>(std::tuple_cat(stages_, std::tuple<S>(S{std::move(f)})), morsel_);
+  }
+
+  template<typename Out, typename F>
+  requires std::invocable<const F &, const Slice<value_type> &, Slice<Out> &>
+  auto then(F f) && {
+    using S = PipelineStage<Out, F>;
+    return Pipeline<In, Stages..., S>(std::tuple_cat(std::move(stages_), std::tuple<S>(S{std::move(f)})), morsel_);
+  }
+
+  /**
+   * @brief Appends a stage mapping each element through `g`.
+   */
+  template<typename G>
+  requires std::invocable<const G &, const value_type &>
+  auto map(G g) const & { return Pipeline(*this).map(std::move(g)); }
+
+  template<typename G>
+  requires std::invocable<const G &, const value_type &>
+  auto map(G g) && {
+    using Out = std::remove_cvref_t<std::invoke_result_t<const G &, const value_type &>>;
+    return std::move(*this).template then<Out>([g = std::move(g)](const Slice<value_type> & in, Slice<Out> & out) {
+      out.append_with(in.size(), [&](Out * dst, size_t n) {
+        const value_type * src = in.data();
+        size_t i = 0;
+        try {
+          for (; i < n; ++i) new (dst + i) Out(g(src[i]));
+        } catch (...) {
+          if constexpr (!Destructible<Out>) for (size_t j = 0; j < i; ++j) dst[j].~Out();
+          throw;
+        }
+      });
+    });
+  }
+
+  /**
+   * @brief Appends a stage keeping only the elements satisfying `pred`.
+   */
+  template<typename P>
+  requires std::predicate<const P &, const value_type &> && std::is_copy_constructible_v<value_type>
+  auto filter(P pred) const & { return Pipeline(*this).filter(std::move(pred)); }
+
+  template<typename P>
+  requires std::predicate<const P &, const value_type &> && std::is_copy_constructible_v<value_type>
+  auto filter(P pred) && {
+    using Out = value_type;
+    return std::move(*this).template then<Out>([pred = std::move(pred)](const Slice<Out> & in, Slice<Out> & out) {
+      if (out.capacity() < out.size() + in.size()) out.reserve(out.size() + in.size());
+      for (const Out & el : in)
+        if (pred(el)) out.append(el);
+    });
+  }
+
+  /**
+   * @brief Runs `this` over `src`, appending the output to `out` in order.
+   *
+   * With several workers, each morsel is first output into a slice of its own, and the slices
+   * are then appended to `out` in order, which costs one more pass over the output.
+   *
+   * @param src The input, which must not overlap `out`.
+   * @param out The slice to append the output to.
+   * @param workers The number of threads, or 0 for one per hardware thread.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void run(const Slice<In> & src, Slice<value_type> & out, size_t workers = 1) const {
+    const size_t morsels = (src.size() + morsel_ - 1) / morsel_;
+    if (workers == 1 || morsels <= 1) {
+      for (size_t k = 0; k < morsels; ++k) morsel(src, k, out);
+      return;
+    }
+    Slice<Slice<value_type>> parts(morsels);
+    for (size_t k = 0; k < morsels; ++k) parts.append(Slice<value_type>());
+    schedule(src.size(), workers, [&](size_t k) { morsel(src, k, parts.data()[k]); });
+    size_t total = out.size();
+    for (const auto & p : parts) total += p.size();
+    out.reserve(total);
+    for (const auto & p : parts) out.append(p.data(), p.size());
+  }
+
+  /**
+   * @brief Runs `this` over `src`, handing the output of each morsel to `sink`.
+   *
+   * `sink(first, output)` is called with the position of the first input element of the morsel
+   * and its output, which lives in a per-thread scratch slice until the next morsel, so that no
+   * output is written to memory unless the sink does. With several workers, `sink` is called
+   * concurrently, in no particular order.
+   *
+   * @param src The input.
+   * @param sink The consumer of the output of each morsel.
+   * @param workers The number of threads, or 0 for one per hardware thread.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void each(const Slice<In> & src, auto && sink, size_t workers = 1) const
+      requires std::invocable<decltype(sink) &, size_t, const Slice<value_type> &> {
+    schedule(src.size(), workers, [&](size_t k) {
+      thread_local Slice<value_type> out;
+      out.truncate(0);
+      morsel(src, k, out);
+      sink(k * morsel_, static_cast<const Slice<value_type> &>(out));
+    });
+  }
+};
+
+#endif // PIPELINE_HXX
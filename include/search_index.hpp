@@ -0,0 +1,243 @@
+#ifndef SEARCH_INDEX_HXX
+#define SEARCH_INDEX_HXX
+
+#include <cppslice.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @class SearchIndex
+ * @brief A static, cache-friendly search index over a sorted `Slice`.
+ *
+ * A `SearchIndex` answers `lower_bound` queries over a sorted `Slice` using a static B+ tree
+ * (S+ tree) layout: the sorted keys are stored in blocks of `B` keys, each one as wide as a cache
+ * line, and on top of them sit layers of internal nodes holding `B` separator keys each.
+ * A lookup touches one node per layer instead of one cache line per halving step, the in-node
+ * comparisons are branchless and vectorized, and batched lookups walk many queries through the
+ * tree layer by layer, prefetching the next node of each one to overlap their memory latencies.
+ *
+ * @note For more information about the layout, refer to
+ *       [Static B-Trees on Algorithmica](https://en.algorithmica.org/hpc/data-structures/s-tree/).
+ *
+ * @tparam T The type of the keys, which must be arithmetic.
+ * @tparam B The number of keys per node, defaulting to one cache line worth of keys.
+ */
+template<typename T, size_t B = 64 / sizeof(T)>
+requires std::is_arithmetic_v<T> && (B > 0)
+class SearchIndex {
+private:
+
+  static constexpr size_t LINE = 64;        ///< The assumed cache line size, in bytes.
+  static constexpr size_t MAX_LAYERS = 64;  ///< An upper bound to the height of the tree.
+  static constexpr size_t BATCH = 16;       ///< The number of queries interleaved per batch.
+  static constexpr T INF = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                                : std::numeric_limits<T>::max();
+
+  Slice<T> nodes_;                 ///< The storage of every layer, plus alignment padding.
+  const T * base_;                 ///< The first cache-line aligned element of `nodes_`.
+  size_t len_;                     ///< The number of keys indexed by `this`.
+  size_t height_;                  ///< The number of layers above the leaves.
+  size_t offset_[MAX_LAYERS + 1];  ///< The offset of each layer from `base_`, leaves first.
+
+  /*–
+   * AF: the sorted sequence [base_[offset_[0]], …, base_[offset_[0] + len_ - 1]], i.e. the leaf
+   *     layer, searchable through the internal layers 1, …, height_ stored at base_ + offset_[h].
+   *
+   * ---
+   *
+   * RI: - layer 0 holds the keys in blocks of B, padded with INF up to a multiple of B
+   *     - layer h has ⌈nodes(h - 1) / (B + 1)⌉ nodes and layer height_ has exactly one node
+   *     - key i of node k in layer h + 1 is the first leaf key of node k · (B + 1) + i + 1 in
+   *       layer h, or INF if that node does not exist
+   *     - every node starts on a cache line boundary whenever B · sizeof(T) is a multiple of it
+   */
+
+  /**
+   * @brief Returns the number of nodes in a layer, given the number in the layer below.
+   */
+  static constexpr size_t parent_nodes(size_t nodes) noexcept { return (nodes + B) / (B + 1); }
+
+  /**
+   * @brief Computes the rank of `x` inside a node.
+   *
+   * Counts the keys of the node that are strictly lower than `x`, i.e. the index of the child to
+   * descend into. The loop has no data-dependent branches, so that compilers turn it into vector
+   * comparisons; AVX2 builds use explicit intrinsics for the 32- and 64-bit integer cases.
+   *
+   * @param node The first key of the node.
+   * @param x The key to rank.
+   * @return The number of keys of the node lower than `x`, in [0, B].
+   */
+  static size_t rank(const T * node, T x) noexcept {
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, int32_t> && B % 8 == 0) {
+      const __m256i v = _mm256_set1_epi32(x);
+      size_t r = 0;
+      for (size_t i = 0; i < B; i += 8) {
+        __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i *>(node + i));
+        r += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(
+         _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, keys)))));
+      }
+      return r;
+    } else if constexpr (std::is_same_v<T, int64_t> && B % 4 == 0) {
+      const __m256i v = _mm256_set1_epi64x(x);
+      size_t r = 0;
+      for (size_t i = 0; i < B; i += 4) {
+        __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i *>(node + i));
+        r += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(
+         _mm256_castsi256_pd(_mm256_cmpgt_epi64(v, keys)))));
+      }
+      return r;
+    }
+#endif
+    size_t r = 0;
+    for (size_t i = 0; i < B; ++i) r += node[i] < x;
+    return r;
+  }
+
+  /**
+   * @brief Returns the first leaf key under node `k` of layer `h`, or INF if it does not exist.
+   */
+  T first_key(size_t h, size_t k) const noexcept {
+    size_t block = k;
+    for (size_t i = 0; i < h; ++i) block *= B + 1;
+    return block * B < len_ ? base_[offset_[0] + block * B] : INF;
+  }
+
+public:
+
+  /**
+   * @brief Slice constructor.
+   *
+   * Creates `this` indexing the keys of a sorted `Slice`. The keys are copied, hence `s` does not
+   * need to outlive `this`.
+   *
+   * @param s The sorted `Slice` to index.
+   *
+   * @throws invalid_argument if `s` is not sorted in non-decreasing order.
+   * @throws Any exception that may be thrown during the allocation.
+   */
+  explicit SearchIndex(const Slice<T> & s) : nodes_(), base_(nullptr), len_(s.size()), height_(0), offset_() {
+    const T * keys = s.data();
+    for (size_t i = 1; i < len_; ++i)
+      if (keys[i] < keys[i - 1]) throw std::invalid_argument("Slice is not sorted.");
+
+    size_t nodes[MAX_LAYERS + 1] = {(len_ + B - 1) / B};
+    size_t total = nodes[0] * B;
+    while (nodes[height_] > 1) {
+      nodes[height_ + 1] = parent_nodes(nodes[height_]);
+      total += nodes[++height_] * B;
+    }
+
+    const size_t pad = LINE / sizeof(T);
+    nodes_ = Slice<T>(total + pad);
+    size_t skip = (LINE - reinterpret_cast<uintptr_t>(nodes_.data()) % LINE) % LINE / sizeof(T);
+    for (size_t i = 0; i < skip; ++i) nodes_.append(INF);
+    base_ = nodes_.data() + skip;
+
+    for (size_t i = 0; i < len_; ++i) nodes_.append(keys[i]);
+    for (size_t i = len_; i < nodes[0] * B; ++i) nodes_.append(INF);
+    for (size_t h = 1; h <= height_; ++h) {
+      offset_[h] = offset_[h - 1] + nodes[h - 1] * B;
+      for (size_t k = 0; k < nodes[h]; ++k)
+        for (size_t i = 0; i < B; ++i) nodes_.append(first_key(h - 1, k * (B + 1) + i + 1));
+    }
+  }
+
+  SearchIndex(const SearchIndex &) = delete;
+  SearchIndex & operator=(const SearchIndex &) = delete;
+
+  SearchIndex(SearchIndex && o) noexcept = default;
+  SearchIndex & operator=(SearchIndex && o) noexcept = default;
+
+  /**
+   * @brief Returns the number of keys indexed by `this`.
+   */
+  size_t size() const noexcept { return len_; }
+
+  /**
+   * @brief Returns the key at the given position of the sorted sequence.
+   *
+   * @param i The position of the key, in [0, size()).
+   */
+  T operator[](size_t i) const noexcept { return base_[offset_[0] + i]; }
+
+  /**
+   * @brief Finds the first key that is not lower than `x`.
+   *
+   * @param x The key to search for.
+   * @return The position of the first key not lower than `x`, or `size()` if there is none.
+   */
+  size_t lower_bound(T x) const noexcept {
+    if (len_ == 0) return 0;
+    size_t k = 0;
+    for (size_t h = height_; h > 0; --h) k = k * (B + 1) + rank(base_ + offset_[h] + k * B, x);
+    size_t i = k * B + rank(base_ + offset_[0] + k * B, x);
+    return i < len_ ? i : len_;
+  }
+
+  /**
+   * @brief Finds the first key that is not lower than each of the given keys.
+   *
+   * Queries are processed in groups of `BATCH`: each group descends the tree one layer at a
+   * time and prefetches the next node of every query before ranking any of them, so that the
+   * cache misses of independent queries overlap instead of adding up.
+   *
+   * @param xs The keys to search for.
+   * @param count The number of keys in `xs`.
+   * @param out The positions of the results, as returned by `lower_bound(T)`.
+   */
+  void lower_bound(const T * xs, size_t count, size_t * out) const noexcept {
+    if (len_ == 0) {
+      for (size_t j = 0; j < count; ++j) out[j] = 0;
+      return;
+    }
+    size_t k[BATCH];
+    for (size_t first = 0; first < count; first += BATCH) {
+      const size_t n = count - first < BATCH ? count - first : BATCH;
+      const T * x = xs + first;
+      for (size_t j = 0; j < n; ++j) k[j] = 0;
+      for (size_t h = height_; h > 0; --h) {
+        const T * layer = base_ + offset_[h];
+        const T * below = base_ + offset_[h - 1];
+        for (size_t j = 0; j < n; ++j) {
+          k[j] = k[j] * (B + 1) + rank(layer + k[j] * B, x[j]);
+          __builtin_prefetch(below + k[j] * B);
+        }
+      }
+      for (size_t j = 0; j < n; ++j) {
+        size_t i = k[j] * B + rank(base_ + offset_[0] + k[j] * B, x[j]);
+        out[first + j] = i < len_ ? i : len_;
+      }
+    }
+  }
+
+  /**
+   * @brief Finds the first key that is not lower than each key of a `Slice`.
+   *
+   * @param xs The keys to search for.
+   * @return A `Slice` with the position of the result of each query, in the same order.
+   *
+   * @throws Any exception that may be thrown during the allocation.
+   */
+  Slice<size_t> lower_bound(const Slice<T> & xs) const {
+    Slice<size_t> out(xs.size());
+    size_t pos[BATCH];
+    for (size_t first = 0; first < xs.size(); first += BATCH) {
+      const size_t n = xs.size() - first < BATCH ? xs.size() - first : BATCH;
+      lower_bound(xs.data() + first, n, pos);
+      for (size_t j = 0; j < n; ++j) out.append(pos[j]);
+    }
+    return out;
+  }
+};
+
+#endif // SEARCH_INDEX_HXX
@@ -0,0 +1,297 @@
+#ifndef SPARSE_SLICE_HXX
+#define SPARSE_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class SparseSlice
+ * @brief A mostly-default collection that only stores its non-default elements.
+ *
+ * A `SparseSlice` of size n stores the positions of its non-default elements, sorted, in one
+ * `Slice<Index>` and the elements in another one (coordinate format), so that its memory is
+ * proportional to the number of non-default elements rather than to n. Every other position
+ * holds `T()`. Random access is a binary search over the positions, and iteration only visits
+ * the stored elements.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Index The type of the positions, which bounds the size of `this`.
+ */
+template<typename T, std::unsigned_integral Index = uint32_t>
+requires std::default_initializable<T> && std::equality_comparable<T>
+class SparseSlice {
+private:
+
+  static inline const T ZERO = T(); ///< The default element.
+
+  size_t len_;       ///< The size of `this`, default elements included.
+  Slice<Index> idx_; ///< The positions of the stored elements, increasing.
+  Slice<T> vals_;    ///< The stored elements, `vals_[k]` at position `idx_[k]`.
+
+  /*–
+   * AF: the sequence [e_0, …, e_{len_ - 1}] with e_{idx_[k]} = vals_[k], and e_i = T() at every
+   *     other position.
+   *
+   * ---
+   *
+   * RI: - idx_.size() = vals_.size()
+   *     - idx_ is strictly increasing, and idx_[k] < len_
+   *     - vals_[k] ≠ T()
+   */
+
+  /**
+   * @brief Returns the rank of the first stored position not lower than `i`.
+   */
+  size_t rank(size_t i) const noexcept {
+    return static_cast<size_t>(std::lower_bound(idx_.begin(), idx_.end(), i) - idx_.begin());
+  }
+
+  /**
+   * @brief Returns whether `n` positions, 0 to n - 1, fit into `Index`.
+   */
+  static constexpr bool fits(size_t n) noexcept {
+    return n == 0 || n - 1 <= size_t(std::numeric_limits<Index>::max());
+  }
+
+  /**
+   * @brief Checks that `other` has the size of `this`.
+   *
+   * @throws std::invalid_argument If it has not.
+   */
+  void expect_size(size_t other) const {
+    if (other != len_) throw std::invalid_argument("Sparse and dense slices of different sizes.");
+  }
+
+public:
+
+  /**
+   * @brief An element stored in a `SparseSlice`, with its position.
+   */
+  struct Entry {
+    size_t index;    ///< The position of the element.
+    const T & value; ///< The element.
+  };
+
+  /**
+   * @brief A forward iterator over the stored elements of a `SparseSlice`, in order.
+   */
+  class Iterator {
+  private:
+
+    const SparseSlice * s_; ///< The iterated collection.
+    size_t k_;              ///< The rank of the current element.
+
+  public:
+
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() noexcept : s_(nullptr), k_(0) {}
+
+    Iterator(const SparseSlice * s, size_t k) noexcept : s_(s), k_(k) {}
+
+    Entry operator*() const noexcept { return Entry{s_->idx_.data()[k_], s_->vals_.data()[k_]}; }
+
+    Iterator & operator++() noexcept { return ++k_, *this; }
+
+    Iterator operator++(int) noexcept {
+      Iterator it = *this;
+      ++k_;
+      return it;
+    }
+
+    bool operator==(const Iterator & o) const noexcept { return k_ == o.k_; }
+  };
+
+  /**
+   * @brief Size constructor.
+   *
+   * Creates `this` with `n` default elements.
+   *
+   * @throws std::length_error If `n` positions do not fit into `Index`.
+   */
+  explicit SparseSlice(size_t n = 0) : len_(n), idx_(), vals_() {
+    if (!fits(n)) throw std::length_error("SparseSlice too large for its Index.");
+  }
+
+  /**
+   * @brief Dense constructor.
+   *
+   * Creates `this` from the non-default elements of `dense`, in one pass.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  explicit SparseSlice(const Slice<T> & dense) : SparseSlice(dense.size()) {
+    for (size_t i = 0; i < dense.size(); ++i)
+      if (!(dense.data()[i] == ZERO)) append(i, dense.data()[i]);
+  }
+
+  /**
+   * @brief Returns the size of `this`, default elements included.
+   */
+  size_t size() const noexcept { return len_; }
+
+  /**
+   * @brief Returns the number of stored (non-default) elements.
+   */
+  size_t nnz() const noexcept { return idx_.size(); }
+
+  /**
+   * @brief Returns the positions of the stored elements, increasing.
+   */
+  const Slice<Index> & indices() const noexcept { return idx_; }
+
+  /**
+   * @brief Returns the stored elements, in the order of their positions.
+   */
+  const Slice<T> & values() const noexcept { return vals_; }
+
+  Iterator begin() const noexcept { return Iterator(this, 0); }
+
+  Iterator end() const noexcept { return Iterator(this, nnz()); }
+
+  /**
+   * @brief Returns the element at position `i`, in O(log nnz()).
+   *
+   * @return A pointer to the stored element, or to `T()` if there is none at `i`.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  const T * operator[](size_t i) const {
+    if (i >= len_) throw std::out_of_range("Invalid argument");
+    const size_t k = rank(i);
+    return k < idx_.size() && idx_.data()[k] == i ? vals_.data() + k : &ZERO;
+  }
+
+  /**
+   * @brief Appends `n` default elements to `this`, in constant time.
+   *
+   * @throws std::length_error If the size of `this` would not fit into `Index`.
+   */
+  void grow(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() - len_ || !fits(len_ + n)) throw std::length_error("SparseSlice too large for its Index.");
+    len_ += n;
+  }
+
+  /**
+   * @brief Stores an element after the last stored one, in amortized constant time.
+   *
+   * @param i The position of the element, after every stored one.
+   * @param v The element; a default one is not stored.
+   *
+   * @throws std::invalid_argument If `i` is not after every stored position.
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  void append(size_t i, auto && v) requires std::constructible_from<T, decltype(v)> {
+    if (i >= len_) throw std::out_of_range("Invalid argument");
+    if (idx_.size() > 0 && i <= idx_.data()[idx_.size() - 1]) throw std::invalid_argument("Position out of order.");
+    T el(std::forward<decltype(v)>(v));
+    if (el == ZERO) return;
+    vals_.append(std::move(el));
+    try {
+      idx_.append(static_cast<Index>(i));
+    } catch (...) {
+      vals_.truncate(vals_.size() - 1);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Sets the element at position `i`.
+   *
+   * Updating a stored element takes O(log nnz()); storing a new one, or setting a stored one to
+   * `T()`, shifts the stored elements after it, in O(nnz()). Use `append()` to build `this`
+   * in order.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void set(size_t i, auto && v) requires std::constructible_from<T, decltype(v)> {
+    if (i >= len_) throw std::out_of_range("Invalid argument");
+    const size_t k = rank(i);
+    const bool stored = k < idx_.size() && idx_.data()[k] == i;
+    T el(std::forward<decltype(v)>(v));
+    if (stored && !(el == ZERO)) {
+      vals_.data()[k] = std::move(el);
+      return;
+    }
+    if (k == idx_.size()) return append(i, std::move(el));
+    if (stored) {
+      std::move(vals_.begin() + k + 1, vals_.end(), vals_.begin() + k);
+      std::move(idx_.begin() + k + 1, idx_.end(), idx_.begin() + k);
+      vals_.truncate(vals_.size() - 1), idx_.truncate(idx_.size() - 1);
+    } else if (!(el == ZERO)) {
+      idx_.append(Index(idx_.data()[idx_.size() - 1]));
+      try {
+        T last(std::move(vals_.data()[vals_.size() - 1]));  // appending may reallocate its source
+        vals_.append(std::move(last));
+      } catch (...) {
+        idx_.truncate(idx_.size() - 1);
+        throw;
+      }
+      std::move_backward(vals_.begin() + k, vals_.end() - 2, vals_.end() - 1);
+      std::move_backward(idx_.begin() + k, idx_.end() - 2, idx_.end() - 1);
+      vals_.data()[k] = std::move(el), idx_.data()[k] = static_cast<Index>(i);
+    }
+  }
+
+  /**
+   * @brief Returns the dense equivalent of `this`.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  Slice<T> dense() const requires std::is_copy_constructible_v<T> {
+    Slice<T> out(len_);
+    size_t k = 0;
+    for (size_t i = 0; i < len_; ++i) {
+      if (k < idx_.size() && idx_.data()[k] == i) out.append(vals_.data()[k++]);
+      else out.append(ZERO);
+    }
+    return out;
+  }
+
+  /**
+   * @brief Returns the dot product of `this` and `y`, touching only the stored elements.
+   *
+   * @throws std::invalid_argument If `y` is not of the size of `this`.
+   */
+  T dot(const Slice<T> & y) const requires std::is_arithmetic_v<T> {
+    expect_size(y.size());
+    const Index * idx = idx_.data();
+    const T * v = vals_.data(), * d = y.data();
+    const size_t n = idx_.size();
+    T acc[4] = {};  // independent partial sums, to overlap the gathers
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+      acc[0] += v[k] * d[idx[k]];
+      acc[1] += v[k + 1] * d[idx[k + 1]];
+      acc[2] += v[k + 2] * d[idx[k + 2]];
+      acc[3] += v[k + 3] * d[idx[k + 3]];
+    }
+    for (; k < n; ++k) acc[0] += v[k] * d[idx[k]];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  }
+
+  /**
+   * @brief Adds `a` times `this` to `y` (y ← a·x + y), touching only the stored elements.
+   *
+   * @throws std::invalid_argument If `y` is not of the size of `this`.
+   */
+  void axpy(T a, Slice<T> & y) const requires std::is_arithmetic_v<T> {
+    expect_size(y.size());
+    const Index * idx = idx_.data();
+    const T * v = vals_.data();
+    T * d = y.data();
+    for (size_t k = 0; k < idx_.size(); ++k) d[idx[k]] += a * v[k];
+  }
+};
+
+#endif // SPARSE_SLICE_HXX
@@ -0,0 +1,189 @@
+#ifndef STREAM_HXX
+#define STREAM_HXX
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief The bytes from which bulk writes bypass the caches, or 0 to use half the LLC.
+ */
+#ifndef SLICE_STREAM_THRESHOLD
+#define SLICE_STREAM_THRESHOLD 0
+#endif
+
+/**
+ * @class StreamStore
+ * @brief Copy and fill kernels writing with non-temporal (streaming) stores.
+ *
+ * A regular store first reads its cache line in, then leaves it in every level of the cache, so
+ * writing a buffer larger than the LLC both reads it once for nothing and evicts the working set
+ * of everything else. A streaming store instead combines whole lines in write-combining buffers
+ * and sends them straight to memory. It pays off for writes too large to be read back from the
+ * cache anyway, which is what `worth()` tells, from an LLC-relative threshold.
+ *
+ * Streaming stores are weakly ordered: every kernel ends with an `sfence`, so that its writes
+ * are visible before anything the calling thread does next (e.g. releasing a lock).
+ *
+ * Each kernel uses the widest stores available (AVX-512, AVX2, then SSE2), writes the unaligned
+ * head and tail of the destination with regular stores, and falls back to regular stores
+ * entirely on other architectures. Since `Slice` includes this header, the stores are emitted
+ * through compiler builtins rather than `<immintrin.h>`, and the LLC is read with `<cstdio>`.
+ */
+class StreamStore {
+private:
+
+#if defined(__AVX512F__)
+  static constexpr size_t WIDTH = 64; ///< The bytes of a streaming store.
+#elif defined(__AVX2__)
+  static constexpr size_t WIDTH = 32;
+#else
+  static constexpr size_t WIDTH = 16;
+#endif
+
+  static constexpr size_t LINE = 64;                       ///< The bytes of a cache line.
+  static constexpr size_t FALLBACK_LLC = size_t(32) << 20; ///< The LLC assumed if unknown.
+
+  /// The `WIDTH` bytes of a streaming store, as a vector.
+  using Vec = long long __attribute__((vector_size(WIDTH)));
+
+  /**
+   * @brief Streams the `WIDTH` bytes at `src` to `dst`, which is aligned to `WIDTH`.
+   */
+  static void store(void * dst, const void * src) noexcept {
+    Vec v;
+    std::memcpy(&v, src, WIDTH);
+#if defined(__SSE2__) && __has_builtin(__builtin_nontemporal_store)
+    __builtin_nontemporal_store(v, static_cast<Vec *>(dst));
+#elif defined(__AVX512F__)
+    __builtin_ia32_movntdq512(static_cast<Vec *>(dst), v);
+#elif defined(__AVX2__)
+    __builtin_ia32_movntdq256(static_cast<Vec *>(dst), v);
+#elif defined(__SSE2__)
+    __builtin_ia32_movntdq(static_cast<Vec *>(dst), v);
+#else
+    std::memcpy(dst, &v, WIDTH);
+#endif
+  }
+
+  static void fence() noexcept {
+#if defined(__SSE2__)
+    __builtin_ia32_sfence();
+#endif
+  }
+
+  /**
+   * @brief Returns the bytes between `p` and the next multiple of `WIDTH`.
+   */
+  static size_t misalignment(const void * p) noexcept {
+    return (WIDTH - reinterpret_cast<uintptr_t>(p) % WIDTH) % WIDTH;
+  }
+
+  /**
+   * @brief Parses a sysfs cache size, such as "32768K".
+   */
+  static size_t parse_size(const char * s) noexcept {
+    size_t bytes = 0;
+    for (; *s >= '0' && *s <= '9'; ++s) bytes = 10 * bytes + size_t(*s - '0');
+    if (*s == 'K') bytes <<= 10;
+    else if (*s == 'M') bytes <<= 20;
+    return bytes;
+  }
+
+  /**
+   * @brief Returns the size of the largest cache, or 0 if it cannot be found.
+   */
+  static size_t read_llc() noexcept {
+    size_t bytes = 0;
+#if defined(__linux__)
+    for (int index = 0; index < 8; ++index) {
+      char path[64], s[32];
+      std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+      std::FILE * in = std::fopen(path, "r");
+      if (!in) continue;
+      if (std::fgets(s, sizeof(s), in)) bytes = std::max(bytes, parse_size(s));
+      std::fclose(in);
+    }
+#endif
+    return bytes;
+  }
+
+  /**
+   * @brief Whether elements of `T` can be written as patterns of `WIDTH` bytes.
+   */
+  template<typename T>
+  static constexpr bool patterned = std::is_trivially_copyable_v<T> && sizeof(T) <= WIDTH && WIDTH % sizeof(T) == 0;
+
+public:
+
+  /**
+   * @brief Returns the size of the last-level cache, read once (32 MiB if unknown).
+   */
+  static size_t llc_bytes() {
+    static const size_t bytes = [] {
+      size_t b = read_llc();
+      return b ? b : FALLBACK_LLC;
+    }();
+    return bytes;
+  }
+
+  /**
+   * @brief Returns the bytes from which a bulk write streams: `SLICE_STREAM_THRESHOLD`, or half
+   *        the LLC.
+   */
+  static size_t threshold() {
+    return SLICE_STREAM_THRESHOLD ? size_t(SLICE_STREAM_THRESHOLD) : llc_bytes() / 2;
+  }
+
+  /**
+   * @brief Returns whether a write of `bytes` should stream.
+   */
+  static bool worth(size_t bytes) { return bytes >= threshold(); }
+
+  /**
+   * @brief Copies `bytes` bytes from `src` to `dst`, which must not overlap.
+   */
+  static void copy(void * dst, const void * src, size_t bytes) noexcept {
+    auto * d = static_cast<unsigned char *>(dst);
+    const auto * s = static_cast<const unsigned char *>(src);
+    const size_t head = std::min(misalignment(d), bytes);
+    std::memcpy(d, s, head);
+    size_t i = head;
+    for (; i + LINE <= bytes; i += LINE)  // a line at a time, so that write-combining buffers flush whole
+      for (size_t b = 0; b < LINE; b += WIDTH) store(d + i + b, s + i + b);
+    for (; i + WIDTH <= bytes; i += WIDTH) store(d + i, s + i);
+    std::memcpy(d + i, s + i, bytes - i);
+    fence();
+  }
+
+  /**
+   * @brief Constructs `n` copies of `value` in the uninitialized storage at `dst`.
+   *
+   * Elements whose size does not divide a streaming store, or a `dst` that is not aligned to
+   * their size, are written with regular stores.
+   */
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  static void fill(T * dst, size_t n, const T & value) noexcept {
+    if constexpr (patterned<T>) {
+      if (reinterpret_cast<uintptr_t>(dst) % sizeof(T) == 0) {
+        alignas(WIDTH) unsigned char pattern[WIDTH];
+        for (size_t b = 0; b < WIDTH; b += sizeof(T)) std::memcpy(pattern + b, &value, sizeof(T));
+        const size_t head = std::min(misalignment(dst) / sizeof(T), n), per = WIDTH / sizeof(T);
+        std::uninitialized_fill_n(dst, head, value);
+        size_t i = head;
+        for (; i + per <= n; i += per) store(dst + i, pattern);
+        std::uninitialized_fill_n(dst + i, n - i, value);
+        fence();
+        return;
+      }
+    }
+    std::uninitialized_fill_n(dst, n, value);
+  }
+};
+
+#endif // STREAM_HXX
@@ -0,0 +1,252 @@
+#ifndef STRING_SLICE_HXX
+#define STRING_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class BasicStringSlice
+ * @brief A collection of strings stored contiguously in a single buffer.
+ *
+ * A `BasicStringSlice` stores the characters of all its strings back to back in one `Slice<char>`
+ * and the boundaries of the strings in a `Slice<Offset>` (the layout of Arrow's string columns),
+ * rather than one heap allocation per string as in a `Slice<std::string>`. Strings are accessed
+ * as `std::string_view`s into the buffer, which are invalidated when `this` grows.
+ *
+ * Sorting compares the first 8 bytes of two strings as a single integer, and only falls back
+ * to comparing the characters when those prefixes are equal.
+ *
+ * @tparam Offset The type of the offsets, `uint32_t` (up to 4 GiB of characters) or `uint64_t`.
+ */
+template<typename Offset>
+requires std::same_as<Offset, uint32_t> || std::same_as<Offset, uint64_t>
+class BasicStringSlice {
+private:
+
+  Slice<char> chars_;     ///< The characters of the strings, back to back.
+  Slice<Offset> offsets_; ///< The boundaries of the strings in `chars_`.
+
+  /*–
+   * AF: the strings [chars_[offsets_[i]], chars_[offsets_[i + 1]]) for 0 ≤ i < offsets_.size() - 1.
+   *
+   * ---
+   *
+   * RI: - offsets_.size() ≥ 1
+   *     - offsets_[offsets_.size() - 1] = chars_.size()
+   *     - offsets_ is non-decreasing
+   *     - offsets_[0] = 0, unless `this` views the strings of another collection
+   */
+
+  Offset offset(size_t i) const noexcept { return offsets_.data()[i]; }
+
+  std::string_view view(size_t i) const noexcept {
+    return std::string_view(chars_.data() + offset(i), offset(i + 1) - offset(i));
+  }
+
+  /**
+   * @brief Checks that `this` can hold `n` characters.
+   *
+   * @throws std::length_error If `n` does not fit into an `Offset`.
+   */
+  static void check_length(size_t n) {
+    if (n > std::numeric_limits<Offset>::max()) throw std::length_error("StringSlice too large for its offsets.");
+  }
+
+public:
+
+  /**
+   * @brief A forward iterator over the strings of a `BasicStringSlice`, as `std::string_view`s.
+   */
+  class Iterator {
+  private:
+
+    const BasicStringSlice * s_; ///< The iterated collection.
+    size_t i_;                   ///< The position of the current string.
+
+  public:
+
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() noexcept : s_(nullptr), i_(0) {}
+
+    Iterator(const BasicStringSlice * s, size_t i) noexcept : s_(s), i_(i) {}
+
+    std::string_view operator*() const noexcept { return s_->view(i_); }
+
+    Iterator & operator++() noexcept { return ++i_, *this; }
+
+    Iterator operator++(int) noexcept {
+      Iterator it = *this;
+      ++i_;
+      return it;
+    }
+
+    bool operator==(const Iterator & o) const noexcept { return i_ == o.i_; }
+  };
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  BasicStringSlice() : chars_(), offsets_(size_t(1)) { offsets_.append(Offset(0)); }
+
+  /**
+   * @brief Range constructor.
+   *
+   * Creates `this` from a range of string-like values. When the range can be traversed twice,
+   * the total length is computed first, so that both buffers are allocated exactly once.
+   *
+   * @param r The range of strings.
+   *
+   * @throws std::length_error If the strings do not fit into `Offset`s.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  template<std::ranges::input_range R>
+  requires std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+  explicit BasicStringSlice(R && r) : BasicStringSlice() {
+    if constexpr (std::ranges::forward_range<R>) {
+      size_t n = 0, bytes = 0;
+      for (auto && e : r) ++n, bytes += std::string_view(e).size();
+      check_length(bytes);
+      chars_.reserve(bytes), offsets_.reserve(n + 1);
+    }
+    for (auto && e : r) append(std::string_view(e));
+  }
+
+  /**
+   * @brief Creates a view over strings stored in the same layout, e.g. by another library.
+   *
+   * The view neither copies nor frees the strings, which must outlive it. The first offset may
+   * be positive, when the strings are a slice of a larger collection. Appending to the view
+   * copies the strings first.
+   *
+   * @param chars The characters of the strings, up to `offsets[n]` at least.
+   * @param offsets The `n + 1` boundaries of the strings in `chars`.
+   * @param n The number of strings.
+   *
+   * @throws std::invalid_argument If `offsets` is `nullptr`.
+   */
+  static BasicStringSlice view(const char * chars, const Offset * offsets, size_t n) {
+    if (offsets == nullptr) throw std::invalid_argument("StringSlice offsets are nullptr.");
+    BasicStringSlice s;
+    s.offsets_ = Slice<Offset>(const_cast<Offset *>(offsets), n + 1);
+    if (offsets[n] > 0) s.chars_ = Slice<char>(const_cast<char *>(chars), size_t(offsets[n]));
+    return s;
+  }
+
+  /**
+   * @brief Returns the number of strings in `this`.
+   */
+  size_t size() const noexcept { return offsets_.size() - 1; }
+
+  /**
+   * @brief Returns the total number of characters in `this`.
+   */
+  size_t bytes() const noexcept { return offset(size()) - offset(0); }
+
+  /**
+   * @brief Returns the characters of every string, back to back.
+   */
+  const Slice<char> & chars() const noexcept { return chars_; }
+
+  /**
+   * @brief Returns the `size() + 1` boundaries of the strings in `chars()`.
+   */
+  const Slice<Offset> & offsets() const noexcept { return offsets_; }
+
+  /**
+   * @brief Returns the string at position `i`.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  std::string_view operator[](size_t i) const {
+    if (i >= size()) throw std::out_of_range("Invalid argument");
+    return view(i);
+  }
+
+  Iterator begin() const noexcept { return Iterator(this, 0); }
+
+  Iterator end() const noexcept { return Iterator(this, size()); }
+
+  /**
+   * @brief Reserves room for `n` strings and `bytes` characters.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void reserve(size_t n, size_t bytes) {
+    check_length(bytes);
+    chars_.reserve(bytes), offsets_.reserve(n + 1);
+  }
+
+  /**
+   * @brief Appends a string to `this`, in amortized constant time per character.
+   *
+   * @param s The string to append, which must not view the characters of `this`.
+   *
+   * @throws std::length_error If the characters of `this` would not fit into `Offset`s.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(std::string_view s) {
+    check_length(chars_.size() + s.size());
+    chars_.append(s.data(), s.size());
+    offsets_.append(static_cast<Offset>(chars_.size()));
+  }
+
+  /**
+   * @brief Returns the first 8 characters of the string at position `i`, as a big-endian integer.
+   *
+   * Shorter strings are padded with zeros, so that comparing the prefixes of two strings orders
+   * them like their first 8 (unsigned) characters; equal prefixes need a full comparison.
+   */
+  uint64_t prefix(size_t i) const noexcept {
+    const std::string_view s = view(i);
+    uint64_t p = 0;
+    for (size_t k = 0; k < 8; ++k)
+      p = (p << 8) | (k < s.size() ? static_cast<unsigned char>(s[k]) : 0u);
+    return p;
+  }
+
+  /**
+   * @brief Sorts the strings of `this` in lexicographic order of their (unsigned) characters.
+   *
+   * The strings are ordered through their 8-byte prefixes first, which resolves most comparisons
+   * with a single integer comparison, and `this` is rebuilt in sorted order in one pass.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void sort() {
+    const size_t n = size();
+    Slice<uint64_t> prefixes(n);
+    Slice<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) prefixes.append(prefix(i)), order.append(i);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      const uint64_t pa = prefixes.data()[a], pb = prefixes.data()[b];
+      if (pa != pb) return pa < pb;
+      const std::string_view sa = view(a), sb = view(b);
+      if (sa.size() <= 8 && sb.size() <= 8) return sa.size() < sb.size();
+      return sa < sb;
+    });
+
+    BasicStringSlice sorted;
+    sorted.reserve(n, bytes());
+    for (size_t i : order) sorted.append(view(i));
+    *this = std::move(sorted);
+  }
+};
+
+using StringSlice = BasicStringSlice<uint32_t>;
+using LargeStringSlice = BasicStringSlice<uint64_t>;
+
+#endif // STRING_SLICE_HXX
@@ -0,0 +1,265 @@
+#ifndef VAR_SLICE_HXX
+#define VAR_SLICE_HXX
+
+#include <cppslice.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <sys/uio.h>
+
+/**
+ * @class VarSlice
+ * @brief A collection of variable-length records stored contiguously in a single payload.
+ *
+ * A `VarSlice` stores its records (e.g. serialized messages) back to back in one `Slice<Elem>`
+ * and their boundaries in a `Slice<uint64_t>`. Records are accessed as spans into the payload,
+ * without copies, and are invalidated when `this` grows or is compacted.
+ *
+ * Erasing a record only marks it; `compact()` then drops every erased record, moving the
+ * payload of the remaining ones in a single pass. `save()` writes the live records as an image
+ * that `view()` can attach to in place, e.g. from a memory-mapped file, so that variable-length
+ * columns are persisted and loaded without copies.
+ *
+ * @tparam Elem The unit of the payload, `std::byte` for binary records.
+ */
+template<typename Elem = std::byte>
+requires std::is_trivially_copyable_v<Elem>
+class VarSlice {
+private:
+
+  static constexpr uint64_t MAGIC = 0x45434953524156; ///< "VARSICE", the serialization tag.
+  static constexpr uint64_t VERSION = 1;              ///< The serialization format version.
+  static constexpr size_t HEADER = 4;                 ///< The words of the header of an image.
+
+  Slice<Elem> payload_;      ///< The records, back to back.
+  Slice<uint64_t> offsets_;  ///< The boundaries of the records in `payload_`.
+  Slice<bool> erased_;       ///< Whether each record is erased; empty if none ever was.
+  size_t dead_;              ///< The number of erased records.
+  bool mapped_;              ///< Whether `payload_` and `offsets_` may view an image.
+
+  /*–
+   * AF: the records [payload_[offsets_[i]], payload_[offsets_[i + 1]]) for 0 ≤ i < size(),
+   *     where the records with erased_[i] are erased.
+   *
+   * ---
+   *
+   * RI: - offsets_.size() ≥ 1
+   *     - offsets_[0] = 0 and offsets_[offsets_.size() - 1] = payload_.size()
+   *     - offsets_ is non-decreasing
+   *     - erased_.size() ∈ {0, offsets_.size() - 1}
+   *     - dead_ = |{i | erased_[i]}|
+   */
+
+  uint64_t offset(size_t i) const noexcept { return offsets_.data()[i]; }
+
+  std::span<const Elem> record(size_t i) const noexcept {
+    return std::span<const Elem>(payload_.data() + offset(i), offset(i + 1) - offset(i));
+  }
+
+  /**
+   * @brief Marks the records appended since the last erasure as not erased.
+   */
+  void track_erased() {
+    if (erased_.size() > 0) while (erased_.size() < size()) erased_.append(false);
+  }
+
+public:
+
+  /**
+   * @brief Default constructor.
+   *
+   * Creates an empty `this`.
+   */
+  VarSlice() : payload_(), offsets_(size_t(1)), erased_(), dead_(0), mapped_(false) { offsets_.append(uint64_t(0)); }
+
+  /**
+   * @brief Returns the number of records in `this`, including the erased ones not yet compacted.
+   */
+  size_t size() const noexcept { return offsets_.size() - 1; }
+
+  /**
+   * @brief Returns the number of erased records not yet compacted.
+   */
+  size_t erased() const noexcept { return dead_; }
+
+  /**
+   * @brief Returns the payload of every record, back to back.
+   */
+  const Slice<Elem> & payload() const noexcept { return payload_; }
+
+  /**
+   * @brief Returns the `size() + 1` boundaries of the records in `payload()`.
+   */
+  const Slice<uint64_t> & offsets() const noexcept { return offsets_; }
+
+  /**
+   * @brief Returns the record at position `i`, or an empty span if it is erased.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  std::span<const Elem> operator[](size_t i) const {
+    if (i >= size()) throw std::out_of_range("Invalid argument");
+    return is_erased(i) ? std::span<const Elem>() : record(i);
+  }
+
+  /**
+   * @brief Checks whether the record at position `i` is erased.
+   */
+  bool is_erased(size_t i) const noexcept { return i < erased_.size() && erased_.data()[i]; }
+
+  /**
+   * @brief Reserves room for `n` records and `elems` elements of payload.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void reserve(size_t n, size_t elems) { payload_.reserve(elems), offsets_.reserve(n + 1); }
+
+  /**
+   * @brief Appends a record to `this`.
+   *
+   * @param r The record, which must not view the payload of `this`.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(std::span<const Elem> r) {
+    payload_.append(r.data(), r.size());
+    offsets_.append(static_cast<uint64_t>(payload_.size()));
+    track_erased();
+  }
+
+  /**
+   * @brief Appends one record per `iovec`, growing the payload at most once.
+   *
+   * @param iov The records.
+   * @param n The number of records.
+   *
+   * @throws std::invalid_argument If a record is not a whole number of `Elem`s.
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void append(const iovec * iov, size_t n) {
+    size_t elems = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (iov[i].iov_len % sizeof(Elem)) throw std::invalid_argument("Record is not a whole number of elements.");
+      elems += iov[i].iov_len / sizeof(Elem);
+    }
+    const size_t len = payload_.size() + elems, cap = payload_.capacity();
+    if (len > cap) payload_.reserve(len > 2 * cap ? len : 2 * cap);
+    const size_t olen = offsets_.size() + n, ocap = offsets_.capacity();
+    if (olen > ocap) offsets_.reserve(olen > 2 * ocap ? olen : 2 * ocap);
+    for (size_t i = 0; i < n; ++i)
+      append(std::span<const Elem>(static_cast<const Elem *>(iov[i].iov_base), iov[i].iov_len / sizeof(Elem)));
+  }
+
+  /**
+   * @brief Marks the record at position `i` as erased, until the next `compact()`.
+   *
+   * @throws std::out_of_range If `i` is not a valid position.
+   */
+  void erase(size_t i) {
+    if (i >= size()) throw std::out_of_range("Invalid argument");
+    if (erased_.size() == 0) {
+      Slice<bool> erased(size());
+      while (erased.size() < size()) erased.append(false);
+      erased_ = std::move(erased);
+    }
+    if (!erased_.data()[i]) erased_.data()[i] = true, ++dead_;
+  }
+
+  /**
+   * @brief Drops the erased records, moving the payload of the others in a single pass.
+   *
+   * Runs of live records are moved with one `memmove` each, and the offsets are rewritten in
+   * place. If `this` views an image, the records are copied into a payload of its own instead.
+   *
+   * @throws Any exception that may be thrown during the operation.
+   */
+  void compact() {
+    if (dead_ == 0) return;
+    if (mapped_) payload_.reserve(payload_.size() + 1), offsets_.reserve(offsets_.size() + 1), mapped_ = false;
+    Elem * p = payload_.data();
+    uint64_t * o = offsets_.data();
+    const size_t n = size();
+    size_t kept = 0;
+    uint64_t end = 0;
+    for (size_t i = 0; i < n;) {
+      if (erased_.data()[i]) {
+        ++i;
+        continue;
+      }
+      size_t j = i;
+      while (j < n && !erased_.data()[j]) ++j;
+      const uint64_t from = o[i], len = o[j] - from;
+      for (size_t k = i; k < j; ++k) o[++kept] = end + (o[k + 1] - from);
+      if (len && end != from) std::memmove(p + end, p + from, len * sizeof(Elem));
+      end += len, i = j;
+    }
+    payload_.truncate(end), offsets_.truncate(kept + 1);
+    erased_ = Slice<bool>(), dead_ = 0;
+  }
+
+  /**
+   * @brief Writes the live records of `this` as an image that `view()` can attach to.
+   *
+   * The image is a header of 4 `uint64_t` (tag, version, records, payload elements), followed
+   * by the offsets and the payload.
+   *
+   * @throws std::runtime_error If the stream cannot be written.
+   */
+  void save(std::ostream & os) const {
+    uint64_t header[HEADER] = {MAGIC, VERSION, size() - dead_, 0};
+    for (size_t i = 0; i < size(); ++i)
+      if (!is_erased(i)) header[3] += offset(i + 1) - offset(i);
+    os.write(reinterpret_cast<const char *>(header), sizeof(header));
+    uint64_t end = 0;
+    os.write(reinterpret_cast<const char *>(&end), sizeof(end));
+    for (size_t i = 0; i < size(); ++i)
+      if (!is_erased(i)) end += offset(i + 1) - offset(i), os.write(reinterpret_cast<const char *>(&end), sizeof(end));
+    for (size_t i = 0; i < size(); ++i)
+      if (!is_erased(i)) os.write(reinterpret_cast<const char *>(record(i).data()), record(i).size_bytes());
+    if (!os) throw std::runtime_error("Failed to write VarSlice.");
+  }
+
+  /**
+   * @brief Attaches to an image written by `save()`, without copying it.
+   *
+   * The returned slice views the offsets and the payload in place, and must not outlive the
+   * image. Appending to it or compacting it copies the records first. The offsets are checked
+   * in one pass, so that no record reaches outside the image.
+   *
+   * @param image The image, aligned to 8 bytes (as a memory mapping is).
+   * @return The slice viewing `image`.
+   *
+   * @throws std::runtime_error If `image` does not hold a valid `VarSlice`.
+   */
+  static VarSlice view(std::span<const std::byte> image) {
+    const auto * h = reinterpret_cast<const uint64_t *>(image.data());
+    if (image.size() < sizeof(uint64_t) * HEADER || reinterpret_cast<uintptr_t>(h) % alignof(uint64_t)
+        || h[0] != MAGIC || h[1] != VERSION)
+      throw std::runtime_error("Image does not hold a VarSlice.");
+    const uint64_t n = h[2], elems = h[3];
+    const size_t body = image.size() - sizeof(uint64_t) * HEADER;
+    if (n >= body / sizeof(uint64_t) || elems > (body - (n + 1) * sizeof(uint64_t)) / sizeof(Elem))
+      throw std::runtime_error("Truncated VarSlice.");
+    auto * o = const_cast<uint64_t *>(h + HEADER);
+    auto * p = const_cast<Elem *>(reinterpret_cast<const Elem *>(o + n + 1));
+    if (reinterpret_cast<uintptr_t>(p) % alignof(Elem) || o[0] != 0 || o[n] != elems)
+      throw std::runtime_error("Corrupted VarSlice.");
+    for (size_t i = 1; i <= n; ++i)
+      if (o[i] < o[i - 1]) throw std::runtime_error("Corrupted VarSlice.");
+    VarSlice s;
+    s.offsets_ = Slice<uint64_t>(o, size_t(n + 1));
+    if (elems) s.payload_ = Slice<Elem>(p, size_t(elems));
+    s.mapped_ = true;
+    return s;
+  }
+
+};
+
+#endif // VAR_SLICE_HXX
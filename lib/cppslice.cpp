@@ -0,0 +1,13 @@
+#include <cppslice.hpp>
+
+/*
+ * Explicit instantiation definitions of `Slice` for the common element types, compiled once into
+ * the library (`make lib`). Translation units that define `SLICE_EXTERN_TEMPLATES`, or import the
+ * `cppslice` module, use these non-template members instead of instantiating their own; member
+ * templates, such as `append(auto &&)`, are still instantiated where they are used.
+ */
+template class Slice<int>;
+template class Slice<float>;
+template class Slice<double>;
+template class Slice<std::byte>;
+template class Slice<char>;
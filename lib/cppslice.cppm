@@ -0,0 +1,18 @@
+/*
+ * The `cppslice` module interface unit (`make module`, with clang).
+ *
+ * Importing the module rather than including cppslice.hpp parses the header and its standard
+ * headers once, and uses the instantiations of the library for the non-template members of
+ * `Slice` over the common element types (member templates are still instantiated by importers).
+ */
+module;
+
+#define SLICE_EXTERN_TEMPLATES
+#include <cppslice.hpp>
+
+export module cppslice;
+
+export using ::Slice;
+export using ::Iterable;
+export using ::HomogeneousArgumented;
+export using ::Destructible;
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""Compares the Google Benchmark results of a plain build with the ones of a PGO build.
+
+Usage: pgo_report.py <plain.json> <pgo.json>
+
+Both files are written by `--benchmark_out=<file> --benchmark_out_format=json`; `make pgo-report`
+produces and compares them. Prints the time of every benchmark in both builds, the speedup of the
+PGO build, and the geometric mean of the speedups.
+"""
+
+import json
+import math
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        runs = json.load(f)["benchmarks"]
+    return {r["name"]: r for r in runs if r.get("run_type", "iteration") == "iteration"}
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(f"Usage: {sys.argv[0]} <plain.json> <pgo.json>")
+    plain, pgo = load(sys.argv[1]), load(sys.argv[2])
+    names = [n for n in plain if n in pgo]
+    if not names:
+        sys.exit("No benchmark in common.")
+
+    width = max(len(n) for n in names)
+    print(f"{'benchmark':<{width}}  {'plain':>12}  {'pgo':>12}  {'speedup':>8}")
+    logs = []
+    for n in names:
+        a, b = plain[n], pgo[n]
+        unit = a.get("time_unit", "ns")
+        speedup = a["real_time"] / b["real_time"] if b["real_time"] > 0 else float("nan")
+        if speedup > 0:
+            logs.append(math.log(speedup))
+        print(f"{n:<{width}}  {a['real_time']:>10.1f}{unit:>2}  {b['real_time']:>10.1f}{unit:>2}  {speedup:>7.2f}x")
+    print(f"\ngeometric mean speedup over {len(logs)} benchmarks: {math.exp(sum(logs) / len(logs)):.3f}x")
+
+
+if __name__ == "__main__":
+    main()
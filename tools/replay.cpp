@@ -0,0 +1,138 @@
+#include <cppslice.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <print>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Replays a trace of `Slice` operations and reports the latency percentiles of each operation.
+ * Build it with `make replay`, which enables the `SLICE_LATENCY` instrumentation.
+ *
+ * A trace has one operation per line; blank lines and lines starting with '#' are ignored:
+ *
+ *   construct <id> <n>    constructs slice <id> from a collection of <n> elements
+ *   append <id> <k>       appends <k> elements to slice <id>, one at a time
+ *   subslice <id> <i> <f> takes the sub-slice [i, f) of slice <id>
+ *   destroy <id>          destroys slice <id>
+ *
+ * Usage: cppslice_replay.x <trace> [threads] [repetitions]
+ *
+ * `make trace` builds the same replayer with the `SLICE_ALLOC_TRACE` instrumentation as well,
+ * and takes the Chrome trace file to write the allocation events to as a fourth argument:
+ *
+ * Usage: cppslice_trace.x <trace> [threads] [repetitions] [out.json]
+ */
+
+/**
+ * @brief An operation of a trace.
+ */
+struct TraceOp {
+  SliceOp op; ///< The operation.
+  size_t id;  ///< The slice the operation applies to.
+  size_t a;   ///< The first argument of the operation, if any.
+  size_t b;   ///< The second argument of the operation, if any.
+};
+
+/**
+ * @brief Parses a trace.
+ *
+ * @param in The stream to parse.
+ * @return The operations of the trace, in order.
+ *
+ * @throws invalid_argument if a line is not a valid operation.
+ */
+static std::vector<TraceOp> parse(std::istream & in) {
+  std::vector<TraceOp> ops;
+  std::string line;
+  for (size_t n = 1; std::getline(in, line); ++n) {
+    std::istringstream ls(line);
+    std::string op;
+    if (!(ls >> op) || op[0] == '#') continue;
+    TraceOp t{SliceOp::Construct, 0, 0, 0};
+    bool ok = false;
+    if (op == "construct") t.op = SliceOp::Construct, ok = static_cast<bool>(ls >> t.id >> t.a);
+    else if (op == "append") t.op = SliceOp::Append, ok = static_cast<bool>(ls >> t.id >> t.a);
+    else if (op == "subslice") t.op = SliceOp::SubSlice, ok = static_cast<bool>(ls >> t.id >> t.a >> t.b);
+    else if (op == "destroy") t.op = SliceOp::Destroy, ok = static_cast<bool>(ls >> t.id);
+    if (!ok) throw std::invalid_argument(std::format("Invalid trace operation at line {}.", n));
+    ops.push_back(t);
+  }
+  return ops;
+}
+
+/**
+ * @brief Drives slices through a trace, from the calling thread.
+ *
+ * Operations on slices that do not exist, or sub-slices out of bounds, are skipped.
+ *
+ * @param ops The operations of the trace.
+ * @param src The elements slices are constructed from, at least as many as the largest one.
+ */
+static void replay(const std::vector<TraceOp> & ops, std::span<int64_t> src) {
+  std::unordered_map<size_t, Slice<int64_t>> live;
+  for (const TraceOp & t : ops) {
+    auto it = live.find(t.id);
+    switch (t.op) {
+      case SliceOp::Construct:
+        live.insert_or_assign(t.id, Slice<int64_t>(src.first(t.a)));
+        break;
+      case SliceOp::Append:
+        if (it == live.end()) break;
+        for (size_t i = 0; i < t.a; ++i) it->second.append(static_cast<int64_t>(i));
+        break;
+      case SliceOp::SubSlice:
+        if (it == live.end() || t.b >= it->second.size() || t.a >= t.b) break;
+        (void) it->second[t.a, t.b];
+        break;
+      case SliceOp::Destroy:
+        if (it != live.end()) live.erase(it);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+int main(int argc, char ** argv) {
+  if (argc < 2) {
+    std::println(stderr, "Usage: {} <trace> [threads] [repetitions]", argv[0]);
+    return 1;
+  }
+  try {
+    std::ifstream in(argv[1]);
+    if (!in) throw std::invalid_argument(std::format("Cannot open {}.", argv[1]));
+    const std::vector<TraceOp> ops = parse(in);
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : 1;
+    const size_t reps = argc > 3 ? std::stoul(argv[3]) : 1;
+
+    size_t largest = 0;
+    for (const TraceOp & t : ops)
+      if (t.op == SliceOp::Construct && t.a > largest) largest = t.a;
+    std::vector<int64_t> src(largest);
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < threads; ++w)
+      workers.emplace_back([&] {
+        for (size_t r = 0; r < reps; ++r) replay(ops, src);
+      });
+    for (auto & w : workers) w.join();
+
+    std::print("{}", LatencyRecorder::report());
+#ifdef SLICE_ALLOC_TRACE
+    const std::string out = argc > 4 ? argv[4] : "slice_trace.json";
+    AllocTracer::flush(out);
+    std::println("{} allocation events written to {}", AllocTracer::count(), out);
+#endif
+  } catch (const std::exception & e) {
+    std::println(stderr, "{}", e.what());
+    return 1;
+  }
+  return 0;
+}